@@ -0,0 +1,26 @@
+#!/bin/bash
+# Priradenia dlhych retazcov: cas a najvacsia rezidentna pamat.
+# Retazec od ROPE_LEAF bajtov sa pri priradeni zdiela, kopiruje sa
+# az pri zmene. Kratky retazec sa kopiruje vzdy, meria sa pre porovnanie.
+
+. "$(dirname "$0")/common.sh"
+
+dir=$(mktemp -d)
+trap 'rm -rf "$dir"' EXIT
+
+${CC:-gcc} -O2 -o "$dir/maxrss" "$(dirname "$0")/maxrss.c" \
+   || { echo "build of maxrss failed" >&2; exit 1; }
+
+# 1 MB retazec, 100k x tri priradenia
+printf 'a = "0123456789" * 100000.0\ni = 0.0\nwhile i < 100000.0\nb = a\nc = b\nd = c\ni = i + 1.0\nend\nprint(d)\n' >"$dir/chain.fal"
+# 10 MB retazec v piatich dalsich premennych
+printf 'a = "0123456789" * 1000000.0\nb = a\nc = a\nd = a\ne = b\nf = c\nprint(f)\n' >"$dir/fanout.fal"
+# Kratky retazec, 1M x dve priradenia
+printf 'a = "short string"\ni = 0.0\nwhile i < 1000000.0\nb = a\nc = b\ni = i + 1.0\nend\nprint(c)\n' >"$dir/short.fal"
+
+printf '%-8s %9s %10s\n' script time maxrss
+for script in chain fanout short; do
+   ms=$(best_ms "$BIN" "$dir/$script.fal") || exit 1
+   kb=$("$dir/maxrss" "$BIN" "$dir/$script.fal" 2>&1 >/dev/null) || exit 1
+   printf '%-8s %6d ms %7d KB\n' "$script" "$ms" "$kb"
+done
@@ -0,0 +1,22 @@
+# Spolocne funkcie benchmarkov, nacitava ich kazdy bench/*.sh
+#
+# BIN   interpret, ktory sa meria (predvolene ./falcon-interpreter)
+# RUNS  pocet behov, vypise sa najlepsi cas
+
+BIN=${BIN:-./falcon-interpreter}
+RUNS=${RUNS:-5}
+
+# best_ms interpret skript [vstup] - najlepsi cas behu v milisekundach
+best_ms()
+{
+   local best=
+   for i in $(seq "$RUNS"); do
+      local start=$(date +%s%N)
+      "$1" "$2" >/dev/null <"${3:-/dev/null}" || return 1
+      local ms=$(( ($(date +%s%N) - start) / 1000000 ))
+      if [ -z "$best" ] || [ "$ms" -lt "$best" ]; then
+         best=$ms
+      fi
+   done
+   echo "$best"
+}
@@ -0,0 +1,22 @@
+#!/bin/bash
+# Porovnanie dispatchu v Interpret(): prelozi interpret so switch
+# a s threaded dispatchom a zmeria ciselny cyklus, konkatenaciu
+# retazcov a cyklus s vela vetvami.
+
+. "$(dirname "$0")/common.sh"
+
+root=$(cd "$(dirname "$0")/.." && pwd)
+dir=$(mktemp -d)
+trap 'rm -rf "$dir"' EXIT
+
+for mode in switch threaded; do
+   make -s --no-print-directory -C "$root" DISPATCH=$mode PROG="$dir/$mode" CC="${CC:-gcc} -O2" >/dev/null 2>&1 \
+      || { echo "build with DISPATCH=$mode failed" >&2; exit 1; }
+done
+
+printf '%-10s %9s %9s\n' script switch threaded
+for script in numeric concat branch; do
+   switch=$(best_ms "$dir/switch" "$root/bench/$script.fal") || exit 1
+   threaded=$(best_ms "$dir/threaded" "$root/bench/$script.fal") || exit 1
+   printf '%-10s %6d ms %6d ms\n' "$script" "$switch" "$threaded"
+done
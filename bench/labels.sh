@@ -0,0 +1,28 @@
+#!/bin/bash
+# Priepustnost cyklu podla poctu navesti v programe. Pred cyklom je
+# N podmienok (kazda ma navestie). Cas cyklu je rozdiel behu s 1M
+# a s 0 iteraciami, preklad sa tak odcita. Od N nema zavisiet.
+
+. "$(dirname "$0")/common.sh"
+
+script=$(mktemp)
+trap 'rm -f "$script"' EXIT
+
+# program labels iteracie
+program()
+{
+   echo 'i = 0.0'
+   for n in $(seq "$1"); do
+      printf 'if i < 0.0\ni = 1.0\nend\n'
+   done
+   printf 'while i < %s\ni = i + 1.0\nend\nprint(i)\n' "$2"
+}
+
+echo 'labels   loop of 1M iterations'
+for labels in 0 100 1000 10000; do
+   program "$labels" 1000000.0 >"$script"
+   full=$(best_ms "$BIN" "$script") || exit 1
+   program "$labels" 0.0 >"$script"
+   empty=$(best_ms "$BIN" "$script") || exit 1
+   printf '%6d   %6d ms\n' "$labels" $((full - empty))
+done
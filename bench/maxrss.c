@@ -0,0 +1,38 @@
+// Spusti prikaz a na stderr vypise jeho najvacsiu rezidentnu pamat v KB.
+// Vystup prikazu zahodi, vrati jeho navratovy kod.
+
+#define _DEFAULT_SOURCE // wait4()
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+
+int main(int argc, char **argv)
+{
+   if (argc < 2) {
+      fprintf(stderr, "pouzitie: maxrss prikaz [argumenty]\n");
+      return EXIT_FAILURE;
+   }
+
+   pid_t pid = fork();
+   if (pid < 0)
+      return EXIT_FAILURE;
+   if (pid == 0) {
+      int fd = open("/dev/null", O_WRONLY);
+      if (fd >= 0)
+         dup2(fd, STDOUT_FILENO);
+      execv(argv[1], argv + 1);
+      _exit(127);
+   }
+
+   int status;
+   struct rusage usage;
+   if (wait4(pid, &status, 0, &usage) < 0)
+      return EXIT_FAILURE;
+
+   fprintf(stderr, "%ld\n", usage.ru_maxrss);
+   return WIFEXITED(status) ? WEXITSTATUS(status) : EXIT_FAILURE;
+}
@@ -0,0 +1,22 @@
+#!/bin/bash
+# Skladanie retazca z 1M znakov: opakovanie, opakovanie na mieste,
+# 100k pripojeni po znaku v cykle a input() jedneho dlheho riadku.
+# Opakovanie bolo pri kapacite rastucej po 8 bajtoch kvadraticke.
+
+. "$(dirname "$0")/common.sh"
+
+dir=$(mktemp -d)
+trap 'rm -rf "$dir"' EXIT
+
+printf 's = "x" * 1000000.0\nprint(s)\n' >"$dir/repeat.fal"
+printf 's = "x"\ns = s * 1000000.0\nprint(s)\n' >"$dir/inplace.fal"
+printf 's = ""\ni = 0.0\nwhile i < 100000.0\ns = s + "x"\ni = i + 1.0\nend\nprint(s)\n' >"$dir/append.fal"
+printf 'input()\n' >"$dir/input.fal"
+head -c 1000000 /dev/zero | tr '\0' x >"$dir/line"
+echo >>"$dir/line"
+
+echo 'script   time'
+for script in repeat inplace append input; do
+   ms=$(best_ms "$BIN" "$dir/$script.fal" "$dir/line") || exit 1
+   printf '%-8s %6d ms\n' "$script" "$ms"
+done
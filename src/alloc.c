@@ -0,0 +1,413 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+//  Falcon Interpreter
+//
+//  for Formal Languages and Compilers 2012/2013
+//  by Varga Tomas, Vojvoda Jakub, Nesvadba Tomas, Spanko Jaroslav, Warzel Adam
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#define _POSIX_C_SOURCE 200112L // posix_memalign()
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#include "alloc.h"
+
+/* Hlavicka pred kazdym blokom: halda, ktorej sa blok zapocital, a jeho
+   velkost. Union drzi zarovnanie, ake ma vysledok malloc().
+*/
+typedef union {
+   struct {
+      T_Heap *heap;
+      size_t size;
+   } info;
+   long double align_ld;
+   void *align_ptr;
+   uint64_t align_u64;
+} T_Block;
+
+/* Kus areny: hlavicka a za nou bloky. Union drzi zarovnanie blokov,
+   vsetky velkosti v arene su nasobkom sizeof(T_Block). Velky blok ma
+   vlastny kus, link ukazuje na ukazovatel, ktory nan odkazuje, aby ho
+   MemFree() mohol vyradit zo zoznamu.
+*/
+struct T_ArenaChunk {
+   union {
+      struct {
+         struct T_ArenaChunk *next;
+         struct T_ArenaChunk **link;
+      } list;
+      T_Block align;
+   } info;
+};
+
+// Prvy kus areny, kazdy dalsi je dvojnasobny az po ARENA_CHUNK
+#define ARENA_FIRST 4096
+// Najvacsi kus areny, bloky nad stvrtinu dostanu vlastny kus
+#define ARENA_CHUNK 65536
+// Slab jednej triedy poolov
+#define POOL_SLAB 2048
+#define ARENA_ALIGN(size) (((size) + sizeof(T_Block) - 1) / sizeof(T_Block) * sizeof(T_Block))
+
+// Halda, ktorej sa zapocitavaju alokacie tohto vlakna
+static __thread T_Heap *current = NULL;
+// Arena, z ktorej ich vlakno prave berie
+static __thread T_Arena *region = NULL;
+// Znacky v hlavicke bloku z areny namiesto haldy
+static T_Heap arena_block;
+static T_Heap arena_large;
+
+void HeapInit(T_Heap *heap)
+{
+   heap->live = 0;
+   heap->peak = 0;
+   heap->quota = 0;
+   heap->exceeded = 0;
+}
+
+T_Heap *HeapSelect(T_Heap *heap)
+{
+   T_Heap *previous = current;
+   current = heap;
+   return previous;
+}
+
+// Zapocita size novych bajtov, alebo odmietne alokaciu nad kvotou
+static int Charge(T_Heap *heap, size_t size)
+{
+   if (heap == NULL)
+      return 1;
+
+   if (heap->quota != 0 && (size > heap->quota || heap->live > heap->quota - size)) {
+      heap->exceeded = 1;
+      return 0;
+   }
+   heap->live += size;
+   if (heap->live > heap->peak)
+      heap->peak = heap->live;
+   return 1;
+}
+
+static void *ArenaAlloc(T_Arena *arena, size_t size);
+
+// Blok z haldy volajuceho vlakna, aj ked je vybrana arena
+static void *HeapAlloc(size_t size)
+{
+   if (size > SIZE_MAX - sizeof(T_Block) || !Charge(current, size))
+      return NULL;
+
+   T_Block *block = malloc(sizeof(T_Block) + size);
+   if (block == NULL) {
+      if (current != NULL)
+         current->live -= size;
+      return NULL;
+   }
+
+   block->info.heap = current;
+   block->info.size = size;
+   return block + 1;
+}
+
+void *MemAlloc(size_t size)
+{
+   return (region != NULL) ? ArenaAlloc(region, size) : HeapAlloc(size);
+}
+
+void *MemCalloc(size_t count, size_t size)
+{
+   if (size != 0 && count > SIZE_MAX / size)
+      return NULL;
+
+   void *ptr = MemAlloc(count * size);
+   if (ptr != NULL)
+      memset(ptr, 0, count * size);
+   return ptr;
+}
+
+/* Zmena velkosti sa zapocita halde, ktorej patri blok. Pri neuspechu
+   zostava povodny blok platny, ako pri realloc().
+*/
+void *MemRealloc(void *ptr, size_t size)
+{
+   if (ptr == NULL)
+      return MemAlloc(size);
+
+   T_Block *block = (T_Block *)ptr - 1;
+   T_Heap *heap = block->info.heap;
+   size_t old = block->info.size;
+
+   /* Posledny blok areny rastie na mieste, ostatne sa prekopiruju
+      a povodny blok sa uvolni cez MemFree().
+   */
+   if (heap == &arena_block || heap == &arena_large) {
+      if (region != NULL && ptr == region->last && size <= SIZE_MAX / 2
+          && ARENA_ALIGN(size) <= (size_t)(region->end - (char *)ptr))
+      {
+         region->next = (char *)ptr + ARENA_ALIGN(size);
+         block->info.size = size;
+         return ptr;
+      }
+      if (size <= old)
+         return ptr;
+
+      void *moved = MemAlloc(size);
+      if (moved != NULL) {
+         memcpy(moved, ptr, old);
+         MemFree(ptr);
+      }
+      return moved;
+   }
+
+   if (size > SIZE_MAX - sizeof(T_Block) || (size > old && !Charge(heap, size - old)))
+      return NULL;
+
+   T_Block *resized = realloc(block, sizeof(T_Block) + size);
+   if (resized == NULL) {
+      if (heap != NULL && size > old)
+         heap->live -= size - old;
+      return NULL;
+   }
+
+   if (heap != NULL && size < old)
+      heap->live -= old - size;
+   resized->info.size = size;
+   return resized + 1;
+}
+
+/* Zarovnany blok: hlavicka lezi na konci prveho useku dlheho alignment
+   (aspon sizeof(T_Block)), data zacinaju za nim, takze su zarovnane
+   rovnako ako cely usek.
+*/
+static size_t AlignedPrefix(size_t alignment)
+{
+   return (alignment < sizeof(T_Block)) ? sizeof(T_Block) : alignment;
+}
+
+void *MemAllocAligned(size_t size, size_t alignment)
+{
+   size_t prefix = AlignedPrefix(alignment);
+   if (size > SIZE_MAX - prefix || !Charge(current, size))
+      return NULL;
+
+   void *raw;
+   if (posix_memalign(&raw, prefix, prefix + size) != 0) {
+      if (current != NULL)
+         current->live -= size;
+      return NULL;
+   }
+
+   char *ptr = (char *)raw + prefix;
+   T_Block *block = (T_Block *)ptr - 1;
+   block->info.heap = current;
+   block->info.size = size;
+   return ptr;
+}
+
+void MemFreeAligned(void *ptr, size_t alignment)
+{
+   if (ptr == NULL)
+      return;
+
+   T_Block *block = (T_Block *)ptr - 1;
+   if (block->info.heap != NULL)
+      block->info.heap->live -= block->info.size;
+   free((char *)ptr - AlignedPrefix(alignment));
+}
+
+// Cislo zoznamu volnych blokov areny s velkostou size: floor(log2(size))
+static unsigned ArenaBin(size_t size)
+{
+   unsigned bin = 0;
+   while (size >>= 1)
+      bin++;
+   return bin;
+}
+
+void MemFree(void *ptr)
+{
+   if (ptr == NULL)
+      return;
+
+   T_Block *block = (T_Block *)ptr - 1;
+   if (block->info.heap == &arena_block) {
+      // Posledny blok areny sa vrati hned, ostatne do zoznamu podla velkosti
+      if (region == NULL)
+         return;
+      if (ptr == region->last) {
+         region->next = (char *)block;
+         region->last = NULL;
+         return;
+      }
+
+      size_t size = ARENA_ALIGN(block->info.size);
+      if (size < sizeof(void *))
+         return;
+      unsigned bin = ArenaBin(size);
+      block->info.size = size;
+      *(void **)ptr = region->bins[bin];
+      region->bins[bin] = ptr;
+      return;
+   }
+   if (block->info.heap == &arena_large) {
+      T_ArenaChunk *chunk = (T_ArenaChunk *)block - 1;
+      *chunk->info.list.link = chunk->info.list.next;
+      if (chunk->info.list.next != NULL)
+         chunk->info.list.next->info.list.link = chunk->info.list.link;
+      MemFree(chunk);
+      return;
+   }
+   if (block->info.heap != NULL)
+      block->info.heap->live -= block->info.size;
+   free(block);
+}
+
+void ArenaInit(T_Arena *arena)
+{
+   arena->chunks = NULL;
+   arena->large = NULL;
+   arena->next = NULL;
+   arena->end = NULL;
+   arena->last = NULL;
+   memset(arena->bins, 0, sizeof(arena->bins));
+   arena->grow = ARENA_FIRST;
+   memset(arena->pools, 0, sizeof(arena->pools));
+}
+
+T_Arena *ArenaSelect(T_Arena *arena)
+{
+   T_Arena *previous = region;
+   region = arena;
+   return previous;
+}
+
+static void *ArenaAlloc(T_Arena *arena, size_t size)
+{
+   if (size > SIZE_MAX / 2)
+      return NULL;
+
+   size_t need = sizeof(T_Block) + ARENA_ALIGN(size);
+   T_Block *block;
+
+   // Velky blok dostane vlastny kus, ktory MemFree() hned uvolni
+   if (need > ARENA_CHUNK / 4) {
+      T_ArenaChunk *chunk = HeapAlloc(sizeof(T_ArenaChunk) + need);
+      if (chunk == NULL)
+         return NULL;
+      chunk->info.list.next = arena->large;
+      chunk->info.list.link = &arena->large;
+      if (arena->large != NULL)
+         arena->large->info.list.link = &chunk->info.list.next;
+      arena->large = chunk;
+
+      block = (T_Block *)(chunk + 1);
+      block->info.heap = &arena_large;
+      block->info.size = size;
+      return block + 1;
+   }
+
+   /* Uvolneny blok: v zozname ceil(log2) su vsetky bloky dost velke,
+      v nasledujucom este najviac styrikrat vacsie, nez treba. Blok si
+      ponecha svoju velkost, MemRealloc() ho do nej zvacsi na mieste.
+   */
+   size_t aligned = ARENA_ALIGN(size);
+   if (aligned >= sizeof(void *)) {
+      unsigned bin = ArenaBin(aligned);
+      if (((size_t)1 << bin) < aligned)
+         bin++;
+      for (unsigned i = bin; i <= bin + 1 && i < ARENA_BINS; i++) {
+         if (arena->bins[i] != NULL) {
+            void *ptr = arena->bins[i];
+            arena->bins[i] = *(void **)ptr;
+            return ptr;
+         }
+      }
+   }
+
+   if (need > (size_t)(arena->end - arena->next)) {
+      size_t chunk_size = arena->grow;
+      if (chunk_size < sizeof(T_ArenaChunk) + need)
+         chunk_size = sizeof(T_ArenaChunk) + need;
+      if (arena->grow < ARENA_CHUNK)
+         arena->grow *= 2;
+
+      T_ArenaChunk *chunk = HeapAlloc(chunk_size);
+      if (chunk == NULL)
+         return NULL;
+      chunk->info.list.next = arena->chunks;
+      arena->chunks = chunk;
+      arena->next = (char *)(chunk + 1);
+      arena->end = (char *)chunk + chunk_size;
+   }
+
+   block = (T_Block *)arena->next;
+   arena->next += need;
+   block->info.heap = &arena_block;
+   block->info.size = size;
+   arena->last = block + 1;
+   return block + 1;
+}
+
+// Uvolni kusy zoznamu, ktory zacina first
+static void ChunksDelete(T_ArenaChunk *first)
+{
+   while (first != NULL) {
+      T_ArenaChunk *chunk = first;
+      first = chunk->info.list.next;
+      MemFree(chunk);
+   }
+}
+
+void ArenaDelete(T_Arena *arena)
+{
+   ChunksDelete(arena->chunks);
+   ChunksDelete(arena->large);
+   ArenaInit(arena);
+}
+
+// Trieda velkosti objektu poolu
+static T_Pool *PoolClass(size_t size)
+{
+   return &region->pools[(size != 0) ? (size - 1) / sizeof(void *) : 0];
+}
+
+void *PoolAlloc(size_t size)
+{
+   if (region == NULL || size > POOL_MAX)
+      return MemAlloc(size);
+
+   T_Pool *pool = PoolClass(size);
+   if (pool->free != NULL) {
+      void *object = pool->free;
+      pool->free = *(void **)object;
+      return object;
+   }
+
+   size_t object_size = (pool - region->pools + 1) * sizeof(void *);
+   if (object_size > (size_t)(pool->end - pool->next)) {
+      char *slab = ArenaAlloc(region, POOL_SLAB);
+      if (slab == NULL)
+         return NULL;
+      pool->next = slab;
+      pool->end = slab + POOL_SLAB;
+   }
+
+   void *object = pool->next;
+   pool->next += object_size;
+   return object;
+}
+
+void PoolFree(void *ptr, size_t size)
+{
+   if (ptr == NULL)
+      return;
+   if (region == NULL || size > POOL_MAX) {
+      MemFree(ptr);
+      return;
+   }
+
+   T_Pool *pool = PoolClass(size);
+   *(void **)ptr = pool->free;
+   pool->free = ptr;
+}
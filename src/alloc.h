@@ -0,0 +1,98 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+//  Falcon Interpreter
+//
+//  for Formal Languages and Compilers 2012/2013
+//  by Varga Tomas, Vojvoda Jakub, Nesvadba Tomas, Spanko Jaroslav, Warzel Adam
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef ALLOC_H
+#define ALLOC_H
+
+#include <stddef.h>
+
+/* Accounting allocator. Every allocation of the interpreter goes through
+   MemAlloc() and friends and is charged to the heap of the instance
+   (T_Context) which the calling thread works for, see HeapSelect().
+   A block remembers its heap, so it may be freed from anywhere.
+   Blocks from MemAlloc() must be freed by MemFree() and vice versa.
+*/
+typedef struct {
+   size_t live; // Bytes allocated and not freed
+   size_t peak; // Highest value of live
+   size_t quota; // Limit of live, 0 for none
+   int exceeded; // An allocation failed because of quota
+} T_Heap;
+
+void HeapInit(T_Heap *heap);
+// Charges allocations of the calling thread to heap (NULL for none), returns the previous heap
+T_Heap *HeapSelect(T_Heap *heap);
+
+void *MemAlloc(size_t size);
+void *MemCalloc(size_t count, size_t size);
+void *MemRealloc(void *ptr, size_t size);
+void MemFree(void *ptr);
+
+/* Block whose address is a multiple of alignment (a power of two),
+   always taken from the heap, even while an arena is selected. It must
+   be freed by MemFreeAligned() with the same alignment.
+*/
+void *MemAllocAligned(size_t size, size_t alignment);
+void MemFreeAligned(void *ptr, size_t alignment);
+
+/* Region for data which dies at once, such as everything the compiler
+   builds before Link(). While an arena is selected, MemAlloc() of the
+   calling thread takes blocks from its chunks, which are charged to the
+   heap as a whole. MemFree() rewinds the newest block, releases a large
+   block and files any other block in a free list by its size, where the
+   next MemAlloc() of about that size finds it. A block must be freed
+   while its arena is selected, otherwise it is kept until ArenaDelete().
+   MemRealloc() grows the newest block in place. ArenaDelete() releases
+   all blocks together; nothing may point to them afterwards.
+*/
+typedef struct T_ArenaChunk T_ArenaChunk;
+
+// Free lists of the arena, list i holds blocks of 2^i to 2^(i+1)-1 bytes
+#define ARENA_BINS 16
+
+// Size classes of PoolAlloc(), one per pointer size up to POOL_MAX bytes
+#define POOL_CLASSES 8
+#define POOL_MAX (POOL_CLASSES * sizeof(void *))
+
+typedef struct {
+   void *free; // Freed objects, linked through their first word
+   char *next; // Rest of the newest slab
+   char *end;
+} T_Pool;
+
+typedef struct {
+   T_ArenaChunk *chunks; // Newest first
+   T_ArenaChunk *large; // Chunks with one large block each
+   char *next; // Free space of the newest chunk
+   char *end;
+   void *last; // Block which ends at next
+   void *bins[ARENA_BINS]; // Freed blocks, linked through their first word
+   size_t grow; // Size of the next chunk
+   T_Pool pools[POOL_CLASSES];
+} T_Arena;
+
+void ArenaInit(T_Arena *arena);
+// Serves allocations of the calling thread from arena (NULL for the heap), returns the previous arena
+T_Arena *ArenaSelect(T_Arena *arena);
+void ArenaDelete(T_Arena *arena);
+
+/* Small fixed-size objects (T_Var, T_Instr, list and hash items).
+   Within an arena they come without a block header from slabs, one slab
+   per size class, and a freed object is reused by the next PoolAlloc()
+   of its size. Without an arena they are ordinary MemAlloc() blocks.
+   An object must be freed by PoolFree() with the size it was allocated
+   with, while the same arena (or none) is selected.
+*/
+void *PoolAlloc(size_t size);
+void PoolFree(void *ptr, size_t size);
+
+#define POOL_NEW(type) ((type *)PoolAlloc(sizeof(type)))
+#define POOL_DELETE(type, ptr) PoolFree((ptr), sizeof(type))
+
+#endif
@@ -0,0 +1,446 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+//  Falcon Interpreter
+//
+//  for Formal Languages and Compilers 2012/2013
+//  by Varga Tomas, Vojvoda Jakub, Nesvadba Tomas, Spanko Jaroslav, Warzel Adam
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+#include <pthread.h>
+#include <time.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <sys/stat.h>
+
+#include "batch.h"
+#include "codes.h"
+#include "falcon.h"
+
+// Jeden skript davky a jeho vysledok
+typedef struct {
+   char *path;
+   char *output; // Zachyteny vystup print()
+   size_t length;
+   size_t capacity;
+   int overflow; // Vystup sa nezmestil do pamate
+   int rc;
+   int64_t latency; // Preklad a beh v ns
+} T_BatchJob;
+
+typedef struct {
+   T_BatchJob *jobs;
+   size_t count;
+   size_t capacity;
+   size_t next; // Prvy skript, ktory si este nevzalo ziadne vlakno
+   pthread_mutex_t lock;
+   const T_BatchLimits *limits; // Limity kazdeho skriptu
+} T_Batch;
+
+static int64_t Now(void)
+{
+   struct timespec now;
+   clock_gettime(CLOCK_MONOTONIC, &now);
+   return (int64_t)now.tv_sec * 1000000000 + now.tv_nsec;
+}
+
+// Prida skript na koniec davky, cestu si skopiruje
+static int AddJob(T_Batch *batch, const char *path)
+{
+   if (batch->count == batch->capacity) {
+      size_t capacity = (batch->capacity == 0) ? 64 : batch->capacity * 2;
+      T_BatchJob *jobs = realloc(batch->jobs, capacity * sizeof(T_BatchJob));
+      if (jobs == NULL)
+         return EXIT_FAILURE;
+      batch->jobs = jobs;
+      batch->capacity = capacity;
+   }
+
+   T_BatchJob *job = &batch->jobs[batch->count];
+   memset(job, 0, sizeof(T_BatchJob));
+   if ((job->path = strdup(path)) == NULL)
+      return EXIT_FAILURE;
+   batch->count++;
+   return EXIT_SUCCESS;
+}
+
+static int ComparePaths(const void *a, const void *b)
+{
+   return strcmp(((const T_BatchJob *)a)->path, ((const T_BatchJob *)b)->path);
+}
+
+// Vsetky obycajne subory adresara okrem skrytych, zoradene podla mena
+static int ReadDirectory(T_Batch *batch, const char *dir)
+{
+   DIR *d = opendir(dir);
+   if (d == NULL)
+      return EXIT_FAILURE;
+
+   int rc = EXIT_SUCCESS;
+   char *path = NULL;
+   for (struct dirent *entry = readdir(d); entry != NULL && rc == EXIT_SUCCESS; entry = readdir(d)) {
+      if (entry->d_name[0] == '.')
+         continue;
+
+      size_t length = strlen(dir) + strlen(entry->d_name) + 2;
+      char *tmp = realloc(path, length);
+      if (tmp == NULL) {
+         rc = EXIT_FAILURE;
+         break;
+      }
+      path = tmp;
+      snprintf(path, length, "%s/%s", dir, entry->d_name);
+
+      struct stat st;
+      if (stat(path, &st) == 0 && S_ISREG(st.st_mode))
+         rc = AddJob(batch, path);
+   }
+   free(path);
+   closedir(d);
+
+   if (rc == EXIT_SUCCESS && batch->count > 1)
+      qsort(batch->jobs, batch->count, sizeof(T_BatchJob), ComparePaths);
+   return rc;
+}
+
+// Manifest: jedna cesta na riadok, prazdne riadky a '#' komentare sa preskocia
+static int ReadManifest(T_Batch *batch, FILE *fd)
+{
+   int rc = EXIT_SUCCESS;
+   char *line = NULL;
+   size_t size = 0;
+   ssize_t length;
+   while (rc == EXIT_SUCCESS && (length = getline(&line, &size, fd)) != -1) {
+      while (length > 0 && (line[length - 1] == '\n' || line[length - 1] == '\r'))
+         line[--length] = '\0';
+      if (length > 0 && line[0] != '#')
+         rc = AddJob(batch, line);
+   }
+
+   if (ferror(fd))
+      rc = EXIT_FAILURE;
+   free(line);
+   return rc;
+}
+
+static int ReadList(T_Batch *batch, const char *list)
+{
+   if (strcmp(list, "-") == 0)
+      return ReadManifest(batch, stdin);
+
+   struct stat st;
+   if (stat(list, &st) != 0)
+      return EXIT_FAILURE;
+   if (S_ISDIR(st.st_mode))
+      return ReadDirectory(batch, list);
+
+   FILE *fd = fopen(list, "r");
+   if (fd == NULL)
+      return EXIT_FAILURE;
+   int rc = ReadManifest(batch, fd);
+   fclose(fd);
+   return rc;
+}
+
+// Vystup print() skriptu, kapacita bufferu sa zdvojnasobuje
+static void Capture(void *data, const char *text, size_t length)
+{
+   T_BatchJob *job = data;
+   if (job->overflow)
+      return;
+
+   if (job->length + length > job->capacity) {
+      size_t capacity = (job->capacity == 0) ? 256 : job->capacity;
+      while (capacity < job->length + length)
+         capacity *= 2;
+      char *output = realloc(job->output, capacity);
+      if (output == NULL) {
+         job->overflow = 1;
+         return;
+      }
+      job->output = output;
+      job->capacity = capacity;
+   }
+
+   memcpy(job->output + job->length, text, length);
+   job->length += length;
+}
+
+/* Pracovne vlakno. Instancia sa vytvori raz na vlakno, kazdy preklad
+   nahradi predchadzajuci program, takze skripty nic nezdielaju.
+*/
+static void *Worker(void *data)
+{
+   T_Batch *batch = data;
+   T_Falcon *falcon = FalconNew();
+   FILE *empty = fopen("/dev/null", "r");
+   FalconSetLimits(falcon, batch->limits->budget, batch->limits->microseconds);
+   FalconSetMemory(falcon, batch->limits->memory);
+
+   for (;;) {
+      pthread_mutex_lock(&batch->lock);
+      size_t i = batch->next;
+      if (i < batch->count)
+         batch->next++;
+      pthread_mutex_unlock(&batch->lock);
+      if (i >= batch->count)
+         break;
+
+      T_BatchJob *job = &batch->jobs[i];
+      if (falcon == NULL || empty == NULL) {
+         job->rc = INTERNAL_ERROR;
+         continue;
+      }
+
+      int64_t start = Now();
+      FalconSetOutput(falcon, Capture, job);
+      FalconSetInput(falcon, empty);
+      job->rc = FalconCompileFile(falcon, job->path);
+      if (job->rc == EXIT_SUCCESS)
+         job->rc = FalconRun(falcon);
+      if (job->rc == EXIT_SUCCESS && job->overflow)
+         job->rc = INTERNAL_ERROR;
+      job->latency = Now() - start;
+   }
+
+   if (empty != NULL)
+      fclose(empty);
+   FalconFree(falcon);
+   return NULL;
+}
+
+static int CompareLatency(const void *a, const void *b)
+{
+   int64_t x = *(const int64_t *)a;
+   int64_t y = *(const int64_t *)b;
+   return (x > y) - (x < y);
+}
+
+// Percentil p (nearest rank) zo zoradenych latencii, v mikrosekundach
+static double Percentile(int64_t *sorted, size_t count, unsigned p)
+{
+   size_t rank = (count * p + 99) / 100;
+   return sorted[(rank > 0) ? rank - 1 : 0] / 1000.0;
+}
+
+static void Report(T_Batch *batch, unsigned threads, int64_t elapsed, FILE *report)
+{
+   size_t failed = 0;
+   for (size_t i = 0; i < batch->count; i++)
+      if (batch->jobs[i].rc != EXIT_SUCCESS)
+         failed++;
+
+   double seconds = elapsed / 1e9;
+   fprintf(report, "batch: %zu scripts, %zu failed, %u threads, %.3f s, %.1f scripts/s\n",
+           batch->count, failed, threads, seconds, (seconds > 0) ? batch->count / seconds : 0.0);
+
+   int64_t *latency = malloc(batch->count * sizeof(int64_t));
+   if (latency == NULL)
+      return;
+   for (size_t i = 0; i < batch->count; i++)
+      latency[i] = batch->jobs[i].latency;
+   qsort(latency, batch->count, sizeof(int64_t), CompareLatency);
+
+   fprintf(report, "latency: p50 %.1f us, p90 %.1f us, p99 %.1f us, max %.1f us\n",
+           Percentile(latency, batch->count, 50), Percentile(latency, batch->count, 90),
+           Percentile(latency, batch->count, 99), latency[batch->count - 1] / 1000.0);
+   free(latency);
+}
+
+int Batch(const char *list, unsigned threads, const T_BatchLimits *limits, FILE *out, FILE *report)
+{
+   T_Batch batch;
+   memset(&batch, 0, sizeof(T_Batch));
+   batch.limits = limits;
+
+   int rc = ReadList(&batch, list);
+   if (rc == EXIT_FAILURE)
+      rc = INTERNAL_ERROR;
+
+   if (rc == EXIT_SUCCESS && batch.count > 0) {
+      if (threads == 0) {
+         long online = sysconf(_SC_NPROCESSORS_ONLN);
+         threads = (online > 0) ? (unsigned)online : 1;
+      }
+      if (threads > batch.count)
+         threads = batch.count;
+
+      pthread_t *pool = malloc(threads * sizeof(pthread_t));
+      if (pool == NULL || pthread_mutex_init(&batch.lock, NULL) != 0) {
+         free(pool);
+         rc = INTERNAL_ERROR;
+      }
+      else {
+         // Ak sa niektore vlakno nevytvori, skripty spracuju ostatne
+         int64_t start = Now();
+         unsigned started = 0;
+         for (unsigned i = 0; i < threads; i++)
+            if (pthread_create(&pool[started], NULL, Worker, &batch) == 0)
+               started++;
+         if (started == 0)
+            Worker(&batch);
+         for (unsigned i = 0; i < started; i++)
+            pthread_join(pool[i], NULL);
+         int64_t elapsed = Now() - start;
+
+         pthread_mutex_destroy(&batch.lock);
+         free(pool);
+
+         for (size_t i = 0; i < batch.count; i++) {
+            T_BatchJob *job = &batch.jobs[i];
+            fprintf(out, "==> %s (%d) <==\n", job->path, job->rc);
+            if (job->length > 0) {
+               fwrite(job->output, 1, job->length, out);
+               if (job->output[job->length - 1] != '\n')
+                  fputc('\n', out);
+            }
+            if (rc == EXIT_SUCCESS)
+               rc = job->rc;
+         }
+         Report(&batch, (started > 0) ? started : 1, elapsed, report);
+      }
+   }
+
+   for (size_t i = 0; i < batch.count; i++) {
+      free(batch.jobs[i].path);
+      free(batch.jobs[i].output);
+   }
+   free(batch.jobs);
+   return rc;
+}
+
+// Jeden usek vstupu v rezime --jobs
+typedef struct {
+   T_Falcon *falcon;
+   FILE *input;
+   T_BatchJob job; // Vystup a navratovy kod behu
+} T_Shard;
+
+static void *RunShard(void *data)
+{
+   T_Shard *shard = data;
+   shard->job.rc = FalconRun(shard->falcon);
+   if (shard->job.rc == EXIT_SUCCESS && shard->job.overflow)
+      shard->job.rc = INTERNAL_ERROR;
+   return NULL;
+}
+
+// Nacita cely subor do pamate, vrati NULL pri chybe
+static char *ReadAll(FILE *fd, size_t *length)
+{
+   size_t capacity = 65536;
+   char *data = malloc(capacity);
+   *length = 0;
+
+   while (data != NULL) {
+      *length += fread(data + *length, 1, capacity - *length, fd);
+      if (*length < capacity)
+         break;
+
+      char *tmp = realloc(data, capacity * 2);
+      if (tmp == NULL) {
+         free(data);
+         return NULL;
+      }
+      data = tmp;
+      capacity *= 2;
+   }
+
+   if (data != NULL && ferror(fd)) {
+      free(data);
+      return NULL;
+   }
+   return data;
+}
+
+int Jobs(const char *file, unsigned jobs, const T_BatchLimits *limits, FILE *in, FILE *out)
+{
+   size_t length;
+   char *input = ReadAll(in, &length);
+   T_Falcon *falcon = FalconNew();
+   T_Shard *shards = calloc(jobs, sizeof(T_Shard));
+   if (input == NULL || falcon == NULL || shards == NULL) {
+      free(input);
+      FalconFree(falcon);
+      free(shards);
+      return INTERNAL_ERROR;
+   }
+
+   /* Useky maju priblizne rovnaky pocet bajtov a koncia za znakom konca
+      riadku. Prazdne useky sa vynechaju, prvy sa vytvori vzdy. Kazdy
+      dalsi beh je kopia prveho, program sa preklada len raz.
+   */
+   FalconSetLimits(falcon, limits->budget, limits->microseconds);
+   FalconSetMemory(falcon, limits->memory);
+   int rc = FalconCompileFile(falcon, file);
+   unsigned count = 0;
+   size_t start = 0;
+   for (unsigned i = 0; rc == EXIT_SUCCESS && i < jobs; i++) {
+      size_t end = (i + 1 == jobs) ? length : length / jobs * (i + 1);
+      if (end < start)
+         end = start;
+      while (end > start && end < length && input[end - 1] != '\n')
+         end++;
+      if (end == start && count > 0)
+         continue;
+
+      T_Shard *shard = &shards[count];
+      shard->falcon = (count == 0) ? falcon : FalconClone(falcon);
+      shard->input = (end > start) ? fmemopen(input + start, end - start, "r") : fopen("/dev/null", "r");
+      if (shard->falcon == NULL || shard->input == NULL) {
+         if (shard->input != NULL)
+            fclose(shard->input);
+         if (count > 0)
+            FalconFree(shard->falcon);
+         rc = INTERNAL_ERROR;
+         break;
+      }
+      FalconSetInput(shard->falcon, shard->input);
+      FalconSetOutput(shard->falcon, Capture, &shard->job);
+      count++;
+      start = end;
+   }
+
+   if (rc == EXIT_SUCCESS) {
+      // Prvy usek bezi vo volajucom vlakne, usek bez vlakna tiez
+      pthread_t *pool = malloc(count * sizeof(pthread_t));
+      int *started = calloc(count, sizeof(int));
+      for (unsigned i = 1; i < count; i++)
+         if (pool != NULL && started != NULL)
+            started[i] = (pthread_create(&pool[i], NULL, RunShard, &shards[i]) == 0);
+
+      RunShard(&shards[0]);
+      for (unsigned i = 1; i < count; i++) {
+         if (started != NULL && started[i])
+            pthread_join(pool[i], NULL);
+         else
+            RunShard(&shards[i]);
+      }
+      free(pool);
+      free(started);
+
+      for (unsigned i = 0; i < count; i++) {
+         if (shards[i].job.length > 0)
+            fwrite(shards[i].job.output, 1, shards[i].job.length, out);
+         if (rc == EXIT_SUCCESS)
+            rc = shards[i].job.rc;
+      }
+   }
+
+   for (unsigned i = 0; i < count; i++) {
+      fclose(shards[i].input);
+      free(shards[i].job.output);
+      if (i > 0)
+         FalconFree(shards[i].falcon);
+   }
+   FalconFree(falcon);
+   free(shards);
+   free(input);
+   return rc;
+}
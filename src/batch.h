@@ -0,0 +1,55 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+//  Falcon Interpreter
+//
+//  for Formal Languages and Compilers 2012/2013
+//  by Varga Tomas, Vojvoda Jakub, Nesvadba Tomas, Spanko Jaroslav, Warzel Adam
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef BATCH_H
+#define BATCH_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stddef.h>
+
+// Limits of every run, 0 for none (see FalconSetLimits() and FalconSetMemory())
+typedef struct {
+   uint64_t budget; // Instructions
+   uint64_t microseconds; // Wall-clock time
+   size_t memory; // Bytes
+} T_BatchLimits;
+
+/* Batch mode of falcon-interpreter. Runs every script named by list on
+   a pool of worker threads, each thread with its own T_Falcon instance.
+
+   list is a directory (all regular files except hidden ones, sorted by
+   name) or a manifest with one path per line, "-" reads the manifest
+   from stdin. Empty lines and lines starting with '#' are skipped.
+   Scripts read no input, input() returns an empty string.
+
+   Captured output of each script goes to out in the order of the list,
+   preceded by "==> path (rc) <==" where rc is its exit code. Throughput
+   and latency percentiles go to report. threads == 0 uses one thread
+   per online CPU. limits bound each script.
+
+   Returns EXIT_SUCCESS if every script succeeded, otherwise the exit code
+   of the first script in the list which failed.
+*/
+int Batch(const char *list, unsigned threads, const T_BatchLimits *limits, FILE *out, FILE *report);
+
+/* Data-parallel mode of falcon-interpreter. Reads all of in, splits it
+   at line boundaries into at most jobs shards of about the same size and
+   runs the script in file once per shard, each run on its own thread with
+   a FalconClone() of one compilation. input() of each run reads only its
+   shard, limits bound each run. Output of the runs goes to out in shard
+   order, so a script which handles every line on its own prints the same
+   as a single run would.
+
+   Returns EXIT_SUCCESS, or the exit code of the compilation or of the
+   first shard which failed.
+*/
+int Jobs(const char *file, unsigned jobs, const T_BatchLimits *limits, FILE *in, FILE *out);
+
+#endif
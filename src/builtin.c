@@ -10,21 +10,30 @@
 #include <errno.h>
 #include <stdlib.h>
 #include <string.h>
+#include <stdio.h>
 #include "builtin.h"
 #include "codes.h"
 #include "types.h"
 #include "macros.h"
 #include "debug.h"
 
-int Input(T_Var *var)
+int Input(T_Context *ctx, T_Var *var)
 {
    DEBUG_INPUT(var);
+   FILE *fd = (ctx->input != NULL) ? ctx->input : stdin;
    if (var == NULL) {
-      T_StringRead(stdin, NULL, '\n');
+      T_StringRead(fd, NULL, '\n');
       return EXIT_SUCCESS;
    }
 
-  T_StringRead(stdin, &(var->vals.str), '\n');
+   // Predchadzajuca hodnota moze byt cislo, ktoreho bajty by sa citali ako retazec
+   T_VarDelete(var);
+   CALL_CHECK(T_StringInit(&(var->vals.str)));
+   var->NID = NID_STRING;
+
+   // errno moze zostat z predchadzajucej operacie (napr. ERANGE z pow)
+   errno = 0;
+   T_StringRead(fd, &(var->vals.str), '\n');
    if (errno) {
       DEBUG_INPUT_END(var);
       return EXIT_FAILURE;
@@ -34,7 +43,16 @@ int Input(T_Var *var)
    return EXIT_SUCCESS;
 }
 
-int Print(T_Var *read_var, T_Var *write_var)
+// Vypise text na vystup kontextu
+static void Output(T_Context *ctx, const char *text, size_t length)
+{
+   if (ctx->output != NULL)
+      ctx->output(ctx->output_data, text, length);
+   else
+      fwrite(text, 1, length, stdout);
+}
+
+int Print(T_Context *ctx, T_Var *read_var, T_Var *write_var)
 {
    DEBUG_PRINT(write_var, read_var);
    // Basic check for NULL pointers
@@ -42,24 +60,31 @@ int Print(T_Var *read_var, T_Var *write_var)
 
    // Printing variable content according to its ID
    if (read_var->NID == NID_NIL)
-      printf("Nil");
+      Output(ctx, "Nil", 3);
 
    if (read_var->NID == NID_BOOL) {
       if (read_var->vals.b_val==0)
-         printf("false");
+         Output(ctx, "false", 5);
       else
-         printf("true");
+         Output(ctx, "true", 4);
    }
 
-   if (read_var->NID == NID_NUMBER)
-      printf("%g",read_var->vals.d_val);
+   if (read_var->NID == NID_NUMBER) {
+      char number[32];
+      int length = snprintf(number, sizeof(number), "%g", NUM_VAL(read_var));
+      Output(ctx, number, length);
+   }
 
    if (read_var->NID == NID_STRING)
-      printf("%s",read_var->vals.str.data);
+      CALL_CHECK(T_VarFlatten(read_var));
+   if (read_var->NID == NID_STRING && read_var->vals.str.data != NULL)
+      Output(ctx, read_var->vals.str.data, strlen(read_var->vals.str.data));
 
-   // Function always returns nil
-   if (write_var != NULL)
+   // Function always returns nil, predtym uvolni retazec z ciela (napr. z input())
+   if (write_var != NULL) {
+      T_VarDelete(write_var);
       write_var->NID = NID_NIL;
+   }
 
    return EXIT_SUCCESS;
 }
@@ -74,6 +99,7 @@ int Numeric(T_Var *write_var, T_Var *read_var)
    if (read_var->NID == NID_NUMBER)
       memcpy(write_var, read_var, sizeof(T_Var));
 
+   CALL_CHECK(T_VarFlatten(read_var));
    char *ukaz;
    double pom = strtod(read_var->vals.str.data, &ukaz);
 
@@ -82,8 +108,7 @@ int Numeric(T_Var *write_var, T_Var *read_var)
       return EXIT_FAILURE;
    }
    else {
-      write_var->vals.d_val = pom; //vrat
-      write_var->NID = NID_NUMBER;
+      CDoubleToT_Var(pom, write_var); //vrat
    }
 
    return EXIT_SUCCESS;
@@ -96,8 +121,7 @@ int TypeOf(T_Var *write_var, T_Var *read_var)
    PTR_CHECK(read_var);
    PTR_CHECK(write_var);
 
-   write_var->NID = NID_NUMBER;
-   write_var->vals.d_val = read_var->NID;
+   CDoubleToT_Var(read_var->NID, write_var);
 
    DEBUG_TYPEOF_END(write_var, read_var);
    return EXIT_SUCCESS;
@@ -109,12 +133,10 @@ int Len(T_Var *write_var, T_Var *read_var)
    PTR_CHECK(read_var);
    PTR_CHECK(write_var);
 
-   write_var->NID = NID_NUMBER;
-
    if (read_var->NID == NID_STRING)
-      write_var->vals.d_val = read_var->vals.str.length;
+      CDoubleToT_Var(VAR_LENGTH(read_var), write_var);
    else
-      write_var->vals.d_val = 0.0;
+      CDoubleToT_Var(0.0, write_var);
 
    DEBUG_LEN_END(write_var, read_var);
    return EXIT_SUCCESS;
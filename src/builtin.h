@@ -12,8 +12,8 @@
 
 #include "types.h"
 
-int Input(T_Var *var);
-int Print(T_Var *read_var, T_Var *write_var);
+int Input(T_Context *ctx, T_Var *var);
+int Print(T_Context *ctx, T_Var *read_var, T_Var *write_var);
 int Numeric(T_Var *read_var, T_Var *write_var);
 int TypeOf(T_Var *read_var, T_Var *write_var);
 int Len(T_Var *read_var, T_Var *write_var);
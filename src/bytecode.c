@@ -0,0 +1,496 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+//  Falcon Interpreter
+//
+//  for Formal Languages and Compilers 2012/2013
+//  by Varga Tomas, Vojvoda Jakub, Nesvadba Tomas, Spanko Jaroslav, Warzel Adam
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <stdint.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <inttypes.h>
+
+#include "alloc.h"
+#include "bytecode.h"
+#include "interpret.h"
+#include "types.h"
+#include "codes.h"
+#include "macros.h"
+
+// FNV-1a, 64 bit
+#define FNV_OFFSET 14695981039346656037ULL
+#define FNV_PRIME 1099511628211ULL
+
+static uint64_t Fnv1a(uint64_t hash, const unsigned char *data, size_t length)
+{
+   for (size_t i = 0; i < length; i++)
+      hash = (hash ^ data[i]) * FNV_PRIME;
+   return hash;
+}
+
+// FNV-1 (najprv nasobenie), nezavisly od FNV-1a v mene suboru v cache
+static uint64_t Fnv1(uint64_t hash, const unsigned char *data, size_t length)
+{
+   for (size_t i = 0; i < length; i++)
+      hash = (hash * FNV_PRIME) ^ data[i];
+   return hash;
+}
+
+// Kontrolny sucet suboru za hlavickou
+static uint64_t Checksum(const char *image, size_t image_size)
+{
+   return Fnv1a(FNV_OFFSET, (const unsigned char *)image + sizeof(T_FbcHeader), image_size - sizeof(T_FbcHeader));
+}
+
+// Zarovna offset nahor na nasobok PROGRAM_ALIGN
+static uint32_t AlignUp(uint32_t offset)
+{
+   return (offset + PROGRAM_ALIGN - 1) / PROGRAM_ALIGN * PROGRAM_ALIGN;
+}
+
+/* Zisti, ci subor zacina hlavickou .fbc. Vrati 1 pre obraz programu,
+   0 pre zdrojovy text (aj pre subor, ktory sa neda otvorit, chybu ohlasi lexer).
+*/
+int BytecodeIsImage(const char *path)
+{
+   char magic[4] = { 0 };
+   FILE *file = fopen(path, "rb");
+   if (file == NULL)
+      return 0;
+
+   size_t read = fread(magic, 1, sizeof(magic), file);
+   fclose(file);
+   return read == sizeof(magic) && memcmp(magic, FBC_MAGIC, sizeof(magic)) == 0;
+}
+
+/* Typy, ktore moze mat slot v subore .fbc. Rezervovane slova (NID_CONST)
+   a funkcie sa do suboru nezapisuju, loader ine typy odmietne.
+*/
+static int IsImageNID(int32_t NID)
+{
+   return NID == NID_UNDEF || NID == NID_NIL || NID == NID_BOOL
+          || NID == NID_NUMBER || NID == NID_STRING;
+}
+
+/* Zapise zlinkovany program do suboru .fbc. Ulozit sa da aj program,
+   ktory uz bezal: instrukcie specializovane Interpret() sa zapisu ako
+   genericke a beh meni len ramec, nie sloty programu. Program, ktory
+   pouziva rezervovane slovo alebo funkciu ako hodnotu, sa neulozi.
+   source je zdroj programu v cache alebo NULL.
+*/
+int BytecodeWrite(T_Program *program, const char *path, const T_FbcSource *source)
+{
+   PTR_CHECK(program);
+   PTR_CHECK(path);
+
+   for (uint32_t i = 0; i < program->nslots; i++) {
+      if (!IsImageNID(program->slots[i].NID)) {
+         errno = RUNTIME_ERROR;
+         return EXIT_FAILURE;
+      }
+   }
+
+   // Rozlozenie suboru
+   T_FbcHeader header;
+   memset(&header, 0, sizeof(header));
+   memcpy(header.magic, FBC_MAGIC, sizeof(header.magic));
+   header.version = FBC_VERSION;
+   header.iid_count = IID_COUNT;
+   header.code_size = sizeof(T_Code);
+   header.size = program->size;
+   header.nslots = program->nslots;
+   header.nglobals = program->nglobals;
+   header.consts_offset = sizeof(T_FbcHeader);
+   header.globals_offset = header.consts_offset + program->nslots * sizeof(T_FbcConst);
+   header.strings_offset = header.globals_offset + program->nglobals * sizeof(T_FbcGlobal);
+   if (source != NULL) {
+      header.source_length = source->length;
+      header.source_hash = source->hash;
+   }
+
+   for (uint32_t i = 0; i < program->nslots; i++) {
+      T_Var *var = &program->slots[i];
+      if (var->NID == NID_STRING && var->vals.str.data != NULL)
+         header.strings_size += STRING_LENGTH(&var->vals.str) + 1;
+   }
+   for (uint32_t i = 0; i < program->nglobals; i++)
+      header.strings_size += strlen(program->globals[i].name) + 1;
+   header.code_offset = AlignUp(header.strings_offset + header.strings_size);
+
+   size_t file_size = header.code_offset + (size_t)program->size * sizeof(T_Code);
+   char *image = MemCalloc(1, file_size);
+   if (image == NULL) {
+      errno = INTERNAL_ERROR;
+      return EXIT_FAILURE;
+   }
+
+   // Konstanty a tabulka retazcov
+   memcpy(image, &header, sizeof(header));
+   T_FbcConst *consts = (T_FbcConst *)(image + header.consts_offset);
+   char *strings = image + header.strings_offset;
+   uint32_t str_offset = 0;
+
+   for (uint32_t i = 0; i < program->nslots; i++) {
+      T_Var *var = &program->slots[i];
+      consts[i].NID = var->NID;
+
+      if (var->NID == NID_NUMBER) {
+         consts[i].sub = var->sub;
+         consts[i].d_val = NUM_VAL(var);
+         if (var->sub == SUB_INT)
+            consts[i].i_val = var->vals.i_val;
+      }
+      else if (var->NID == NID_BOOL)
+         consts[i].i_val = var->vals.b_val;
+      else if (var->NID == NID_STRING && var->vals.str.data == NULL)
+         consts[i].str_offset = FBC_NO_STRING;
+      else if (var->NID == NID_STRING) {
+         consts[i].str_offset = str_offset;
+         consts[i].str_length = STRING_LENGTH(&var->vals.str);
+         memcpy(strings + str_offset, var->vals.str.data, STRING_LENGTH(&var->vals.str));
+         str_offset += STRING_LENGTH(&var->vals.str) + 1;
+      }
+   }
+
+   T_FbcGlobal *globals = (T_FbcGlobal *)(image + header.globals_offset);
+   for (uint32_t i = 0; i < program->nglobals; i++) {
+      globals[i].slot = program->globals[i].slot;
+      globals[i].name_offset = str_offset;
+      globals[i].name_length = strlen(program->globals[i].name);
+      memcpy(strings + str_offset, program->globals[i].name, globals[i].name_length);
+      str_offset += globals[i].name_length + 1;
+   }
+
+   T_Code *code = (T_Code *)(image + header.code_offset);
+   memcpy(code, program->code, (size_t)program->size * sizeof(T_Code));
+   for (uint32_t i = 0; i < program->size; i++)
+      code[i].IID = GenericIID(code[i].IID);
+   ((T_FbcHeader *)image)->checksum = Checksum(image, file_size);
+
+   // Zapis
+   FILE *file = fopen(path, "wb");
+   if (file == NULL) {
+      MemFree(image);
+      errno = INTERNAL_ERROR;
+      return EXIT_FAILURE;
+   }
+
+   size_t written = fwrite(image, 1, file_size, file);
+   MemFree(image);
+   if (fclose(file) != 0 || written != file_size) {
+      errno = INTERNAL_ERROR;
+      return EXIT_FAILURE;
+   }
+
+   return EXIT_SUCCESS;
+}
+
+// Operand je slot ramca alebo NO_SLOT
+static int IsSlot(int32_t arg, uint32_t nslots)
+{
+   return arg == NO_SLOT || (arg >= 0 && (uint32_t)arg < nslots);
+}
+
+// Operandy, ktore Run() pouziva ako sloty bez kontroly NO_SLOT
+#define USE_ARG1 1
+#define USE_ARG2 2
+#define USE_ARG3 4
+
+static int UsedSlots(int IID)
+{
+   switch (IID) {
+      case IID_BRAFAL:
+      case IID_INPUT:
+      case IID_CUT: // Hranice arg2 a arg3 Run() kontroluje
+         return USE_ARG1;
+      case IID_BR_EQUAL:   case IID_BR_UNEQUAL: case IID_BR_BEQUAL:
+      case IID_BR_SMEQUAL: case IID_BR_SMALLER: case IID_BR_BIGGER:
+         return USE_ARG2 | USE_ARG3;
+      // Dvojoperandovy tvar x = x op y ma arg3 == NO_SLOT
+      case IID_PLUS: case IID_DIFF: case IID_MUL: case IID_DIV: case IID_PWR:
+      case IID_COPY: case IID_APPEND:
+      case IID_NUMERIC: case IID_PRINT: case IID_TYPEOF: case IID_LEN: case IID_SORT:
+         return USE_ARG1 | USE_ARG2;
+      case IID_EQUAL:   case IID_UNEQUAL: case IID_BEQUAL:
+      case IID_SMEQUAL: case IID_SMALLER: case IID_BIGGER:
+      case IID_FIND:
+         return USE_ARG1 | USE_ARG2 | USE_ARG3;
+      default:
+         return 0;
+   }
+}
+
+/* Skontroluje operandy instrukcii, aby zly subor nemohol siahnut mimo
+   ramca. Operand, ktory Run() pouziva bez kontroly, musi byt slot,
+   NO_SLOT moze mat len tam, kde ho Run() testuje. Subor obsahuje len
+   genericke instrukcie (viz BytecodeWrite()), specializovane varianty
+   a IID_LOOP by Run() prepisoval priamo v mapovanych strankach.
+*/
+static int CheckCode(T_Code *code, uint32_t size, uint32_t nslots)
+{
+   if (size == 0 || code[size - 1].IID != IID_HALT)
+      return EXIT_FAILURE;
+
+   for (uint32_t i = 0; i < size; i++) {
+      T_Code *c = &code[i];
+      int32_t args[3] = { c->arg1, c->arg2, c->arg3 };
+      int32_t target = NO_TARGET;
+      int jump = -1; // Operand so skokom namiesto slotu
+
+      if (c->IID < 0 || c->IID >= IID_COUNT || GenericIID(c->IID) != c->IID)
+         return EXIT_FAILURE;
+
+      if (c->IID == IID_JUMP || (c->IID >= IID_BR_EQUAL && c->IID <= IID_BR_BIGGER))
+         jump = 0;
+      else if (c->IID == IID_BRAFAL)
+         jump = 1;
+      // Rez bez oboch hranic by Run() cital z arg3
+      if (c->IID == IID_CUT && c->arg2 == NO_SLOT && c->arg3 == NO_SLOT)
+         return EXIT_FAILURE;
+
+      int used = UsedSlots(c->IID);
+      for (int k = 0; k < 3; k++) {
+         if (k == jump)
+            target = args[k];
+         else if (!IsSlot(args[k], nslots) || ((used & (1 << k)) && args[k] == NO_SLOT))
+            return EXIT_FAILURE;
+      }
+
+      // NO_TARGET Run() kontroluje len v IID_JUMP a IID_BRAFAL
+      if (target == NO_TARGET && jump >= 0 && c->IID != IID_JUMP && c->IID != IID_BRAFAL)
+         return EXIT_FAILURE;
+      if (target != NO_TARGET && (target < 0 || (uint32_t)target >= size))
+         return EXIT_FAILURE;
+   }
+
+   return EXIT_SUCCESS;
+}
+
+// Retazec z tabulky retazcov, NULL ak nelezi cely v tabulke
+static char *TableString(T_FbcHeader *header, char *strings, uint32_t offset, uint32_t length)
+{
+   if ((uint64_t)offset + length >= header->strings_size || strings[offset + length] != '\0')
+      return NULL;
+   return strings + offset;
+}
+
+// Zrusi ciastocne nacitany program poskodeneho suboru
+static int LoadFailed(T_Program *program)
+{
+   T_ProgramDelete(program);
+   errno = RUNTIME_ERROR;
+   return EXIT_FAILURE;
+}
+
+// Vytvori sloty a mena premennych programu z overeneho obrazu .fbc
+static int LoadImage(T_Program *program, T_FbcHeader *header, char *image)
+{
+   // Sloty z tabulky konstant
+   T_FbcConst *consts = (T_FbcConst *)(image + header->consts_offset);
+   char *strings = image + header->strings_offset;
+
+   for (uint32_t i = 0; i < header->nslots; i++) {
+      T_Var *var = &program->slots[i];
+      if (!IsImageNID(consts[i].NID))
+         return LoadFailed(program);
+      var->NID = consts[i].NID;
+
+      // Celociselnost sa urci z hodnoty znova
+      if (var->NID == NID_NUMBER)
+         CDoubleToT_Var(consts[i].d_val, var);
+      else if (var->NID == NID_BOOL)
+         var->vals.b_val = (uint8_t)consts[i].i_val;
+      else if (var->NID == NID_STRING && consts[i].str_offset == FBC_NO_STRING)
+         var->vals.str.data = NULL;
+      else if (var->NID == NID_STRING) {
+         char *str = TableString(header, strings, consts[i].str_offset, consts[i].str_length);
+         if (str == NULL || CStringToT_String(str, &var->vals.str) == EXIT_FAILURE) {
+            var->NID = NID_UNDEF;
+            return LoadFailed(program);
+         }
+      }
+   }
+
+   // Mena premennych skriptu, zoradene podla mena
+   if (header->nglobals > 0 && (program->globals = MemAlloc(header->nglobals * sizeof(T_Global))) == NULL) {
+      T_ProgramDelete(program);
+      errno = INTERNAL_ERROR;
+      return EXIT_FAILURE;
+   }
+
+   T_FbcGlobal *globals = (T_FbcGlobal *)(image + header->globals_offset);
+   for (uint32_t i = 0; i < header->nglobals; i++) {
+      char *name = TableString(header, strings, globals[i].name_offset, globals[i].name_length);
+      if (name == NULL || globals[i].slot >= header->nslots
+          || (i > 0 && strcmp(program->globals[i - 1].name, name) >= 0))
+         return LoadFailed(program);
+
+      if ((program->globals[i].name = MemAlloc(globals[i].name_length + 1)) == NULL) {
+         T_ProgramDelete(program);
+         errno = INTERNAL_ERROR;
+         return EXIT_FAILURE;
+      }
+      memcpy(program->globals[i].name, name, globals[i].name_length + 1);
+      program->globals[i].slot = globals[i].slot;
+      program->nglobals++;
+   }
+
+   return EXIT_SUCCESS;
+}
+
+/* Namapuje subor .fbc len na citanie a pripravi z neho program. Instrukcie
+   sa vykonavaju priamo z mapovanych stranok, procesy spustajuce ten isty
+   subor ich zdielaju. Pred prvym specializovanim instrukcie ich Interpret()
+   presunie na haldu instancie (T_ProgramUnmap()). Sloty sa vytvoria
+   z tabulky konstant. Mapovanie uvolni T_ProgramDelete(). Subor s inym
+   kontrolnym suctom alebo ineho zdroja (ak source nie je NULL) sa odmietne.
+*/
+int BytecodeLoad(const char *path, T_Program *program, const T_FbcSource *source)
+{
+   PTR_CHECK(path);
+   PTR_CHECK(program);
+
+   int fd = open(path, O_RDONLY);
+   if (fd < 0) {
+      errno = INTERNAL_ERROR;
+      return EXIT_FAILURE;
+   }
+
+   struct stat st;
+   if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(T_FbcHeader)) {
+      close(fd);
+      errno = INTERNAL_ERROR;
+      return EXIT_FAILURE;
+   }
+
+   size_t image_size = st.st_size;
+   char *image = mmap(NULL, image_size, PROT_READ, MAP_PRIVATE, fd, 0);
+   close(fd);
+   if (image == MAP_FAILED) {
+      errno = INTERNAL_ERROR;
+      return EXIT_FAILURE;
+   }
+
+   // Hlavicka a rozsahy jednotlivych casti
+   T_FbcHeader *header = (T_FbcHeader *)image;
+   if (memcmp(header->magic, FBC_MAGIC, sizeof(header->magic)) != 0
+       || header->version != FBC_VERSION
+       || header->iid_count != IID_COUNT
+       || header->code_size != sizeof(T_Code)
+       || header->consts_offset < sizeof(T_FbcHeader)
+       || header->consts_offset + (uint64_t)header->nslots * sizeof(T_FbcConst) > header->globals_offset
+       || header->globals_offset + (uint64_t)header->nglobals * sizeof(T_FbcGlobal) > header->strings_offset
+       || (uint64_t)header->strings_offset + header->strings_size > header->code_offset
+       || header->code_offset % PROGRAM_ALIGN != 0
+       || header->code_offset + (uint64_t)header->size * sizeof(T_Code) > image_size
+       || (source != NULL && (header->source_length != source->length || header->source_hash != source->hash))
+       || header->checksum != Checksum(image, image_size))
+   {
+      munmap(image, image_size);
+      errno = RUNTIME_ERROR;
+      return EXIT_FAILURE;
+   }
+
+   T_Code *code = (T_Code *)(image + header->code_offset);
+   if (CheckCode(code, header->size, header->nslots) == EXIT_FAILURE) {
+      munmap(image, image_size);
+      errno = RUNTIME_ERROR;
+      return EXIT_FAILURE;
+   }
+
+   if (T_ProgramInit(program, 0, header->nslots) == EXIT_FAILURE) {
+      munmap(image, image_size);
+      return EXIT_FAILURE;
+   }
+   program->code = code;
+   program->size = header->size;
+   program->image = image;
+   program->image_size = image_size;
+
+   return LoadImage(program, header, image);
+}
+
+/* Vrati cestu k programu v cache pre zdrojovy subor path (treba uvolnit
+   MemFree()) a do source zapise jeho dlzku a druhy hash. Do hashu v mene
+   vstupuje aj verzia formatu a pocet instrukcii, po zmene interpretu sa
+   tak stare subory len prestanu pouzivat. Vrati NULL, ak sa zdroj neda
+   precitat.
+*/
+char *BytecodeCachePath(const char *dir, const char *path, T_FbcSource *source)
+{
+   FILE *file = fopen(path, "rb");
+   if (file == NULL)
+      return NULL;
+
+   uint32_t salt[2] = { FBC_VERSION, IID_COUNT };
+   uint64_t hash = Fnv1a(FNV_OFFSET, (unsigned char *)salt, sizeof(salt));
+   source->length = 0;
+   source->hash = FNV_OFFSET;
+
+   unsigned char buffer[4096];
+   size_t read;
+   while ((read = fread(buffer, 1, sizeof(buffer), file)) > 0) {
+      hash = Fnv1a(hash, buffer, read);
+      source->hash = Fnv1(source->hash, buffer, read);
+      source->length += read;
+   }
+
+   int failed = ferror(file);
+   fclose(file);
+   if (failed)
+      return NULL;
+
+   size_t length = strlen(dir) + sizeof("/0123456789abcdef.fbc");
+   char *cached = MemAlloc(length);
+   if (cached == NULL)
+      return NULL;
+   snprintf(cached, length, "%s/%016" PRIx64 ".fbc", dir, hash);
+   return cached;
+}
+
+/* Ulozi program do cache. Zapisuje sa do docasneho suboru v tom istom
+   adresari a ten sa premenuje, subezne spustenie tak uvidi bud cely
+   subor, alebo ziadny. Meno docasneho suboru vytvori mkstemp(), aby sa
+   nestretli ani vlakna jedneho procesu.
+*/
+int BytecodePublish(T_Program *program, const char *path, const T_FbcSource *source)
+{
+   PTR_CHECK(program);
+   PTR_CHECK(path);
+
+   size_t length = strlen(path) + sizeof(".tmp.XXXXXX");
+   char *tmp = MemAlloc(length);
+   if (tmp == NULL) {
+      errno = INTERNAL_ERROR;
+      return EXIT_FAILURE;
+   }
+   snprintf(tmp, length, "%s.tmp.XXXXXX", path);
+
+   int fd = mkstemp(tmp);
+   if (fd < 0) {
+      MemFree(tmp);
+      errno = INTERNAL_ERROR;
+      return EXIT_FAILURE;
+   }
+   close(fd);
+
+   if (BytecodeWrite(program, tmp, source) == EXIT_FAILURE || rename(tmp, path) != 0) {
+      remove(tmp);
+      MemFree(tmp);
+      errno = INTERNAL_ERROR;
+      return EXIT_FAILURE;
+   }
+
+   MemFree(tmp);
+   return EXIT_SUCCESS;
+}
@@ -0,0 +1,89 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+//  Falcon Interpreter
+//
+//  for Formal Languages and Compilers 2012/2013
+//  by Varga Tomas, Vojvoda Jakub, Nesvadba Tomas, Spanko Jaroslav, Warzel Adam
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef BYTECODE_H
+#define BYTECODE_H
+
+#include <stdint.h>
+
+#include "types.h"
+
+/* Precompiled program (.fbc). Numbers are stored in the byte order of the
+   machine which wrote the file. Everything is addressed by offsets from the
+   start of the file, so the file is mapped and run without relocations:
+
+   T_FbcHeader
+   T_FbcConst[nslots]  initial content of frame slots (constant pool)
+   T_FbcGlobal[nglobals] names of script variables, sorted by name
+   char strings[]      string table, each string ends with '\0'
+   T_Code code[size]   instruction array at a PROGRAM_ALIGN aligned offset,
+                       jump targets are already resolved to indices
+
+   The header carries a checksum of everything after it, a damaged file
+   is rejected as a whole. A cached program also records its source.
+*/
+#define FBC_MAGIC "FBC"
+// Bump whenever the layout below or the IID_* numbering changes
+#define FBC_VERSION 3
+// str_offset of a string slot without data
+#define FBC_NO_STRING UINT32_MAX
+
+typedef struct {
+   char magic[4]; // FBC_MAGIC
+   uint32_t version; // FBC_VERSION
+   uint32_t iid_count; // IID_COUNT of the writer
+   uint32_t code_size; // sizeof(T_Code) of the writer
+   uint32_t size; // Number of instructions
+   uint32_t nslots; // Number of frame slots
+   uint32_t nglobals; // Number of named variables
+   uint32_t consts_offset;
+   uint32_t globals_offset;
+   uint32_t strings_offset;
+   uint32_t strings_size;
+   uint32_t code_offset;
+   uint64_t source_length; // Bytes of the cached source, 0 outside the cache
+   uint64_t source_hash; // Hash of the cached source, independent of the file name
+   uint64_t checksum; // Hash of the file after the header
+} T_FbcHeader;
+
+typedef struct {
+   int32_t NID; // Type of the slot
+   int32_t sub; // Subtype of NID_NUMBER
+   double d_val; // Number
+   int64_t i_val; // Integer of SUB_INT numbers, bool value
+   uint32_t str_offset; // String, offset into the string table
+   uint32_t str_length;
+} T_FbcConst;
+
+typedef struct {
+   uint32_t slot; // Frame slot of the variable
+   uint32_t name_offset; // Name, offset into the string table
+   uint32_t name_length;
+} T_FbcGlobal;
+
+/* Cache of compiled programs. The directory in FBC_CACHE_ENV holds one
+   .fbc file per distinct source, named by a hash of the source bytes.
+   A second hash and the length of the source are stored in the file,
+   so a file name collision loads nothing.
+*/
+#define FBC_CACHE_ENV "FALCON_CACHE_DIR"
+
+// Identity of a source file (NULL for a program without one)
+typedef struct {
+   uint64_t length;
+   uint64_t hash;
+} T_FbcSource;
+
+int BytecodeIsImage(const char *path);
+int BytecodeWrite(T_Program *program, const char *path, const T_FbcSource *source);
+int BytecodeLoad(const char *path, T_Program *program, const T_FbcSource *source);
+char *BytecodeCachePath(const char *dir, const char *path, T_FbcSource *source);
+int BytecodePublish(T_Program *program, const char *path, const T_FbcSource *source);
+
+#endif
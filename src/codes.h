@@ -20,6 +20,8 @@
 #define TYPE_COMPATIBILITY_ERROR 11
 #define TYPE_CHANGE_ERROR 12
 #define RUNTIME_ERROR 13
+#define LIMIT_EXCEEDED 14 // Instruction budget or deadline of a run ran out
+#define MEMORY_EXCEEDED 15 // Memory quota of an instance ran out
 #define INTERNAL_ERROR 99
 
 #endif
@@ -9,12 +9,15 @@
 
 #include "debug.h"
 
+#ifndef OUR_DEBUG
+int debug = 0;
+#else
+int debug = 1;
+#endif
+
 void DebugInit()
 {
-   #ifndef OUR_DEBUG
-      debug = 0;
-   #else
-      debug = 1;
+   #ifdef OUR_DEBUG
       printf("---------------------------- DEBUGGER Inicializovan ----------------------------\n");
    #endif
 }
@@ -12,7 +12,7 @@
 
 #include <stdio.h>
 
-int debug;
+extern int debug; // Nastavuje sa len pri preklade (OUR_DEBUG), vlakna ho iba citaju
 
 void DebugInit();
 
@@ -110,7 +110,7 @@ if (debug) printf("---- T_STRING INIT START ----\n" \
 #define DEBUG_STRINGINIT_END(str) do { \
    if (debug) { \
       printf("  Vypis retezce po inicializaci:\n"); \
-      printf("  T_String: \"%s\", size=%d\n", str->data, str->length); \
+      printf("  T_String: \"%s\", size=%d\n", str->data, (int)STRING_LENGTH(str)); \
       printf("---- T_STRING INIT END ----\n"); \
    } \
 } while (0)
@@ -122,9 +122,9 @@ if (debug) printf("---- T_STRING DELETE START ----\n" \
 #define DEBUG_STRING_DELETE_END(str) do { \
    if (debug) { \
       printf("  Vypis retezce pred smazanim:\n"); \
-      printf("  T_String: \"%s\", size=%d\n", str->data, str->length); \
+      printf("  T_String: \"%s\", size=%d\n", str->data, (int)STRING_LENGTH(str)); \
       printf("  Vypis retezce po smazani:\n"); \
-      printf("  T_String: \"%s\", size=%d\n", str->data, str->length); \
+      printf("  T_String: \"%s\", size=%d\n", str->data, (int)STRING_LENGTH(str)); \
       printf("---- T_STRING DELETE END ----\n"); \
    } \
 } while (0)
@@ -137,16 +137,16 @@ if (debug) printf("---- T_STRING COPY START ----\n" \
 #define DEBUG_STRING_COPY_1(str1, str2) do { \
    if (debug) { \
       printf("  Obsah promennych pred kopirovanim:\n"); \
-      printf("  dest : \"%s\", size=%d\n", str1->data, str1->length); \
-      printf("  src  : \"%s\", size=%d\n", str2->data, str2->length); \
+      printf("  dest : \"%s\", size=%d\n", str1->data, (int)STRING_LENGTH(str1)); \
+      printf("  src  : \"%s\", size=%d\n", str2->data, (int)STRING_LENGTH(str2)); \
    } \
 } while (0)
 
 #define DEBUG_STRING_COPY_2(str1, str2) do { \
    if (debug) { \
       printf("  Obsah promennych po kopirovani:\n"); \
-      printf("  dest : \"%s\", size=%d\n", str1->data, str1->length); \
-      printf("  src  : \"%s\", size=%d\n", str2->data, str2->length); \
+      printf("  dest : \"%s\", size=%d\n", str1->data, (int)STRING_LENGTH(str1)); \
+      printf("  src  : \"%s\", size=%d\n", str2->data, (int)STRING_LENGTH(str2)); \
       printf("---- T_STRING COPY END ----\n"); \
    } \
 } while (0)
@@ -158,7 +158,7 @@ if (debug) printf("---- T_STRING READ START ----\n" \
 #define DEBUG_STRINGREAD_END(str) do { \
    if (debug) { \
       printf("  Obsah prom. po citani zo suboru\n"); \
-      printf("  T_String : \"%s\", size=%d\n", str->data, str->length); \
+      printf("  T_String : \"%s\", size=%d\n", str->data, (int)STRING_LENGTH(str)); \
       printf("---- T_STRING READ END ----\n"); \
    } \
 } while (0)
@@ -170,7 +170,7 @@ if (debug) printf("---- T_STRING APPEND START ----\n" \
 #define DEBUG_STRINGAPPEND(str,c) do { \
    if (debug) { \
       printf("  Obsah prom. pred pridanim\n"); \
-      printf("  T_String : \"%s\", size=%d\n", str->data, str->length); \
+      printf("  T_String : \"%s\", size=%d\n", str->data, (int)STRING_LENGTH(str)); \
       printf("  Prida na koniec : %d\n", c); \
    } \
 } while (0)
@@ -178,7 +178,7 @@ if (debug) printf("---- T_STRING APPEND START ----\n" \
 #define DEBUG_STRINGAPPEND_END(str) do { \
    if (debug) { \
       printf("  Obsah prom. po pridani\n"); \
-      printf("  T_String : \"%s\", size=%d\n", str->data, str->length); \
+      printf("  T_String : \"%s\", size=%d\n", str->data, (int)STRING_LENGTH(str)); \
       printf("---- T_STRING APPEND END ----\n"); \
    } \
 } while (0)
@@ -191,16 +191,16 @@ if (debug) printf("---- T_STRING CAT START ----\n" \
 #define DEBUG_STRINGCAT(str) do { \
    if (debug) { \
       printf("  Obsah promennych pred konkatenaciou\n"); \
-      printf("  dest : \"%s\", size=%d\n", dest->data, dest->length); \
-      printf("  src  : \"%s\", size=%d\n", src->data, src->length); \
+      printf("  dest : \"%s\", size=%d\n", dest->data, (int)STRING_LENGTH(dest)); \
+      printf("  src  : \"%s\", size=%d\n", src->data, (int)STRING_LENGTH(src)); \
    } \
 } while (0)
 
 #define DEBUG_STRINGCAT_END(str1,str2) do { \
    if (debug) { \
       printf("  Obsah promennych po konkatenacii\n"); \
-      printf("  dest : \"%s\", size=%d\n", str1->data, str1->length); \
-      printf("  src  : \"%s\", size=%d\n", str2->data, str2->length); \
+      printf("  dest : \"%s\", size=%d\n", str1->data, (int)STRING_LENGTH(str1)); \
+      printf("  src  : \"%s\", size=%d\n", str2->data, (int)STRING_LENGTH(str2)); \
       printf("---- T_STRING CAT END ----\n"); \
    } \
 } while (0)
@@ -217,7 +217,7 @@ if (debug) printf("---- T_STRING CAT START ----\n" \
 #define DEBUG_CSTR2TSTR_END(cstr, str) do { \
    if (debug) { \
       printf("  Obsah po zmene\n"); \
-      printf("  T_String: \"%s\", size=%d\n",str->data, str->length); \
+      printf("  T_String: \"%s\", size=%d\n",str->data, (int)STRING_LENGTH(str)); \
       printf("---- STRING TO T_STRING END ----\n"); \
    } \
 } while (0)
@@ -328,7 +328,7 @@ if (debug) printf("---- T_ARGLIST APPEND START ----\n" \
       printf("  Obsah arg. zoznamu pred pridanim\n"); \
       T_ArgListPrint(list); \
       printf("  Prida na koniec:\n"); \
-      printf("  T_String: \"%s\", length=%d\n",instr->data, instr->length); \
+      printf("  T_String: \"%s\", length=%d\n",instr->data, (int)STRING_LENGTH(instr)); \
    } \
 } while (0)
 
@@ -341,72 +341,6 @@ if (debug) printf("---- T_ARGLIST APPEND START ----\n" \
 } while (0)
 
 
-// T_AllocList ----------------------------------------------------------------
-#define DEBUG_TALLOCLISTINIT(list) \
-if (debug) printf("---- T_ALLOCLIST INIT START ----\n" \
-                  "  T_AllocList na adrese: %p\n", (void *)list)
-
-#define DEBUG_TALLOCLISTINIT_END(list) do { \
-   if (debug) { \
-      printf("  Vypis promenne po inicializaci:\n"); \
-      T_AllocListPrint(list); \
-      printf("---- T_ALLOCLIST INIT END ----\n"); \
-   } \
-} while (0)
-
-#define DEBUG_TALLOCLISTDELETE_START(list) \
-if (debug) printf("---- T_ALLOCLIST DELETE START ----\n" \
-                  "  T_AllocList na adrese: %p\n", (void *)list)
-
-#define DEBUG_TALLOCLISTDELETE_END(list) do { \
-   if (debug) { \
-      printf("  Vypis promenne pred smazanim:\n"); \
-      T_AllocListPrint(list); \
-      printf("  Vypis promenne po smazani:\n"); \
-      T_AllocListPrint(list); \
-      printf("---- T_ALLOCLIST DELETE END ----\n"); \
-   } \
-} while (0)
-
-#define DEBUG_TALLOCLISTAPPEND_START(list,instr) \
-if (debug) printf("---- T_ALLOCLIST APPEND START ----\n" \
-                  " T_AllocList na adrese: %p Pridavana uk. na adrese: %p\n", (void *)list, (void *)instr)
-
-#define DEBUG_TALLOCLISTAPPEND(list,instr) do { \
-   if (debug) { \
-      printf("  Obsah alloc. zoznamu pred pridanim\n"); \
-      T_AllocListPrint(list); \
-      printf("  Prida na koniec: void*: %p",(void *)instr); \
-   } \
-} while (0)
-
-#define DEBUG_TALLOCLISTAPPEND_END(list,instr) do { \
-   if (debug) { \
-      printf("  Obsah alloc. zoznamu po pridani\n"); \
-      T_AllocListPrint(list); \
-      printf("---- T_ALLOCLIST APPEND END ----\n"); \
-   } \
-} while (0)
-
-#define DEBUG_TALLOCLISTDELETELAST_START(list) \
-if (debug) printf("---- T_ALLOCLIST DELETE_LAST START ----\n" \
-                  "  T_AllocList na adrese: %p\n", (void *)list)
-
-#define DEBUG_TALLOCLISTDELETELAST(list) do { \
-   if (debug) { \
-      printf("  Obsah alloc. zoznamu pred odstranenim posledneho\n"); \
-      T_AllocListPrint(list); \
-   } \
-} while (0)
-
-#define DEBUG_TALLOCLISTDELETELAST_END(list) do { \
-   if (debug) { \
-      printf("  Obsah alloc. zoznamu po odstraneni posledneho\n"); \
-      T_AllocListPrint(list); \
-      printf("---- T_ALLOCLIST DELETE_LAST END ----\n"); \
-   } \
-} while (0)
-
 // T_Instr --------------------------------------------------------------------
 #define DEBUG_TINSTRINIT(instr) \
 if (debug) printf("---- T_INSTR INIT START ----\n" \
@@ -583,12 +517,12 @@ if (debug) printf("----------------------------------- LEX START ---------------
 #define DEBUG_GET_TOKEN_END \
 if (debug) printf("------------------------------------ LEX END -----------------------------------\n")
 
-#define DEBUG_INTERPRET(list) do { \
+#define DEBUG_INTERPRET(program) do { \
    if (debug) { \
       printf("-------------------------------- INTERPRET START ------------------------------\n" \
-             "Seznam instrukci na adrese: %p\n" \
-             "Vypis zoznamu instrukcii: \n", (void *)list); \
-      T_ListPrint(list); \
+             "Program na adrese: %p\n" \
+             "Vypis programu: \n", (void *)program); \
+      T_ProgramPrint(program); \
       printf("--------------------------------------------------------------------------------\n"); \
    } \
 } while (0)
@@ -707,12 +641,7 @@ if (debug) printf("-- interpret T_INSTR DELETE --\n")
    if (debug) { \
       printf("  Interpret == JUMP\n"); \
       OperationPrint(current->IID); \
-      printf("  arg1: \n"); \
-      T_VarPrint(current->arg1); \
-      printf("  arg2: \n"); \
-      T_VarPrint(current->arg2); \
-      printf("  arg3: \n"); \
-      T_VarPrint(current->arg3); \
+      printf("  args: %d, %d, %d\n", current->arg1, current->arg2, current->arg3); \
    } \
 } while (0)
 
@@ -720,12 +649,7 @@ if (debug) printf("-- interpret T_INSTR DELETE --\n")
    if (debug) { \
       printf("  Interpret == COPY\n"); \
       OperationPrint(current->IID); \
-      printf("  arg1: \n"); \
-      T_VarPrint(current->arg1); \
-      printf("  arg2: \n"); \
-      T_VarPrint(current->arg2); \
-      printf("  arg3: \n"); \
-      T_VarPrint(current->arg3); \
+      printf("  args: %d, %d, %d\n", current->arg1, current->arg2, current->arg3); \
    } \
 } while (0)
 
@@ -733,12 +657,7 @@ if (debug) printf("-- interpret T_INSTR DELETE --\n")
    if (debug) { \
       printf("  Interpret == BRAFAL\n"); \
       OperationPrint(current->IID); \
-      printf("  arg1: \n"); \
-      T_VarPrint(current->arg1); \
-      printf("  arg2: \n"); \
-      T_VarPrint(current->arg2); \
-      printf("  arg3: \n"); \
-      T_VarPrint(current->arg3); \
+      printf("  args: %d, %d, %d\n", current->arg1, current->arg2, current->arg3); \
    } \
 } while (0)
 
@@ -746,12 +665,7 @@ if (debug) printf("-- interpret T_INSTR DELETE --\n")
    if (debug) { \
       printf("  Interpret == PLUS\n"); \
       OperationPrint(current->IID); \
-      printf("  arg1: \n"); \
-      T_VarPrint(current->arg1); \
-      printf("  arg2: \n"); \
-      T_VarPrint(current->arg2); \
-      printf("  arg3: \n"); \
-      T_VarPrint(current->arg3); \
+      printf("  args: %d, %d, %d\n", current->arg1, current->arg2, current->arg3); \
    } \
 } while (0)
 
@@ -759,12 +673,7 @@ if (debug) printf("-- interpret T_INSTR DELETE --\n")
    if (debug) { \
       printf("Interpret == MINUS\n"); \
       OperationPrint(current->IID); \
-      printf("  arg1: \n"); \
-      T_VarPrint(current->arg1); \
-      printf("  arg2: \n"); \
-      T_VarPrint(current->arg2); \
-      printf("  arg3: \n"); \
-      T_VarPrint(current->arg3); \
+      printf("  args: %d, %d, %d\n", current->arg1, current->arg2, current->arg3); \
    } \
 } while (0)
 
@@ -772,12 +681,7 @@ if (debug) printf("-- interpret T_INSTR DELETE --\n")
    if (debug) { \
       printf("  Interpret == KRAT\n"); \
       OperationPrint(current->IID); \
-      printf("  arg1: \n"); \
-      T_VarPrint(current->arg1); \
-      printf("  arg2: \n"); \
-      T_VarPrint(current->arg2); \
-      printf("  arg3: \n"); \
-      T_VarPrint(current->arg3); \
+      printf("  args: %d, %d, %d\n", current->arg1, current->arg2, current->arg3); \
    } \
 } while (0)
 
@@ -785,12 +689,7 @@ if (debug) printf("-- interpret T_INSTR DELETE --\n")
    if (debug) { \
       printf("Interpret == DELENO\n"); \
       OperationPrint(current->IID); \
-      printf("  arg1: \n"); \
-      T_VarPrint(current->arg1); \
-      printf("  arg2: \n"); \
-      T_VarPrint(current->arg2); \
-      printf("  arg3: \n"); \
-      T_VarPrint(current->arg3); \
+      printf("  args: %d, %d, %d\n", current->arg1, current->arg2, current->arg3); \
    } \
 } while (0)
 
@@ -798,12 +697,7 @@ if (debug) printf("-- interpret T_INSTR DELETE --\n")
    if (debug) { \
       printf("Interpret == MOCNINA ** \n"); \
       OperationPrint(current->IID); \
-      printf("  arg1: \n"); \
-      T_VarPrint(current->arg1); \
-      printf("  arg2: \n"); \
-      T_VarPrint(current->arg2); \
-      printf("  arg3: \n"); \
-      T_VarPrint(current->arg3); \
+      printf("  args: %d, %d, %d\n", current->arg1, current->arg2, current->arg3); \
    } \
 } while (0)
 
@@ -811,12 +705,7 @@ if (debug) printf("-- interpret T_INSTR DELETE --\n")
    if (debug) { \
       printf("Interpret == CUT ** \n"); \
       OperationPrint(current->IID); \
-      printf("  arg1: \n"); \
-      T_VarPrint(current->arg1); \
-      printf("  arg2: \n"); \
-      T_VarPrint(current->arg2); \
-      printf("  arg3: \n"); \
-      T_VarPrint(current->arg3); \
+      printf("  args: %d, %d, %d\n", current->arg1, current->arg2, current->arg3); \
    } \
 } while (0)
 
@@ -0,0 +1,433 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+//  Falcon Interpreter
+//
+//  for Formal Languages and Compilers 2012/2013
+//  by Varga Tomas, Vojvoda Jakub, Nesvadba Tomas, Spanko Jaroslav, Warzel Adam
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <ctype.h>
+
+#include "alloc.h"
+#include "falcon.h"
+#include "bytecode.h"
+#include "codes.h"
+#include "debug.h"
+#include "ial.h"
+#include "interpret.h"
+#include "lex.h"
+#include "linker.h"
+#include "optimize.h"
+#include "synan.h"
+#include "types.h"
+
+// Navratovy kod API po neuspechu vnutornej funkcie
+static int Error(T_Falcon *falcon)
+{
+   if (falcon->heap.exceeded)
+      return MEMORY_EXCEEDED;
+   return (errno != 0) ? errno : INTERNAL_ERROR;
+}
+
+/* Od volania API az po Leave() sa alokacie vlakna zapocitavaju halde
+   instancie. Vrati haldu, ktoru vlakno pouzivalo predtym.
+*/
+static T_Heap *Enter(T_Falcon *falcon)
+{
+   errno = 0;
+   falcon->heap.exceeded = 0;
+   return HeapSelect(&falcon->heap);
+}
+
+static int Leave(T_Heap *previous, int rc)
+{
+   HeapSelect(previous);
+   return rc;
+}
+
+// Zrusi program a ramec, nastavenia instancie ostanu
+static void Release(T_Falcon *falcon)
+{
+   T_FrameDelete(&falcon->program, falcon->frame);
+   T_ProgramDelete(&falcon->program);
+   falcon->frame = NULL;
+   falcon->loops = 0;
+   falcon->suspended = 0;
+}
+
+/* Prelozi zdrojovy text, ktory uz otvoril LexInit() alebo LexInitBuffer(),
+   a zlinkuje ho do programu instancie. Vsetko, co vytvori parser
+   a optimalizator, lezi v arene prekladu a zanikne naraz hned po Link(),
+   ktory program instancie alokuje na halde.
+*/
+static int Compile(T_Falcon *falcon)
+{
+   T_Arena arena;
+   ArenaInit(&arena);
+   T_Arena *previous = ArenaSelect(&arena);
+
+   T_List inst_list;
+   T_LabelList lbl_list;
+   T_ListInit(&inst_list);
+   T_LabelListInit(&lbl_list);
+
+   int rc = SynanInit(falcon, &inst_list, &lbl_list);
+   if (rc == EXIT_SUCCESS) {
+      DEBUG_MAIN_SYNAN;
+      rc = Synan(falcon);
+      DEBUG_MAIN_SYNAN_END;
+
+      T_OptStats stats;
+      if (rc == EXIT_SUCCESS && (rc = Optimize(&inst_list, &lbl_list, &stats)) == EXIT_SUCCESS && falcon->stats != NULL)
+         OptimizeStatsPrint(&stats, falcon->stats);
+
+      if (rc == EXIT_SUCCESS) {
+         ArenaSelect(previous);
+         rc = Link(&inst_list, &lbl_list, falcon->id_table, &falcon->program);
+      }
+   }
+
+   ArenaSelect(previous);
+   SynanFinish(falcon);
+   ArenaDelete(&arena);
+   LexFinish(falcon);
+
+   return rc;
+}
+
+T_Falcon *FalconNew(void)
+{
+   T_Falcon *falcon = malloc(sizeof(T_Falcon));
+   if (falcon == NULL)
+      return NULL;
+
+   if (T_ContextInit(falcon) == EXIT_FAILURE) {
+      free(falcon);
+      return NULL;
+   }
+   return falcon;
+}
+
+void FalconFree(T_Falcon *falcon)
+{
+   if (falcon != NULL) {
+      T_ContextDelete(falcon);
+      free(falcon);
+   }
+}
+
+void FalconSetOutput(T_Falcon *falcon, T_FalconOutput output, void *data)
+{
+   if (falcon != NULL) {
+      falcon->output = output;
+      falcon->output_data = data;
+   }
+}
+
+void FalconSetInput(T_Falcon *falcon, FILE *fd)
+{
+   if (falcon != NULL)
+      falcon->input = fd;
+}
+
+void FalconSetLimits(T_Falcon *falcon, uint64_t instructions, uint64_t microseconds)
+{
+   if (falcon != NULL) {
+      falcon->budget = instructions;
+      falcon->timeout = (microseconds < UINT64_MAX / 1000) ? microseconds * 1000 : UINT64_MAX;
+   }
+}
+
+void FalconSetMemory(T_Falcon *falcon, size_t bytes)
+{
+   if (falcon != NULL)
+      falcon->heap.quota = bytes;
+}
+
+void FalconMemory(T_Falcon *falcon, size_t *live, size_t *peak)
+{
+   if (falcon == NULL)
+      return;
+   if (live != NULL)
+      *live = falcon->heap.live;
+   if (peak != NULL)
+      *peak = falcon->heap.peak;
+}
+
+void FalconSetStats(T_Falcon *falcon, FILE *fd)
+{
+   if (falcon != NULL)
+      falcon->stats = fd;
+}
+
+int FalconCompile(T_Falcon *falcon, const char *source, size_t length)
+{
+   if (falcon == NULL || source == NULL)
+      return INTERNAL_ERROR;
+
+   T_Heap *previous = Enter(falcon);
+   Release(falcon);
+   if (LexInitBuffer(falcon, source, length) == EXIT_FAILURE || Compile(falcon) == EXIT_FAILURE
+       || T_FrameInit(&falcon->program, &falcon->frame) == EXIT_FAILURE)
+   {
+      Release(falcon);
+      return Leave(previous, Error(falcon));
+   }
+
+   return Leave(previous, EXIT_SUCCESS);
+}
+
+// Preklad alebo nacitanie suboru pre FalconCompileFile()
+static int CompileFile(T_Falcon *falcon, const char *path)
+{
+   Release(falcon);
+
+   // Predkompilovany program sa len namapuje, lexer ani parser sa nespustaju
+   if (BytecodeIsImage(path)) {
+      if (BytecodeLoad(path, &falcon->program, NULL) == EXIT_FAILURE
+          || T_FrameInit(&falcon->program, &falcon->frame) == EXIT_FAILURE)
+      {
+         Release(falcon);
+         return Error(falcon);
+      }
+      return EXIT_SUCCESS;
+   }
+
+   /* Cache: zhodny zdroj sa uz prekladal, spusti sa ulozeny program.
+      Poskodeny subor v cache alebo subor ineho zdroja sa prelozi znova
+      a prepise. Premenne nastavene pred prekladom menia program
+      a statistiky optimalizatora vznikaju len pri preklade, vtedy sa
+      cache nepouziva.
+   */
+   char *cache_dir = getenv(FBC_CACHE_ENV);
+   char *cached = NULL;
+   T_FbcSource source;
+   if (cache_dir != NULL && *cache_dir != '\0' && falcon->globals == NULL && falcon->stats == NULL)
+      cached = BytecodeCachePath(cache_dir, path, &source);
+
+   if (cached != NULL && BytecodeLoad(cached, &falcon->program, &source) == EXIT_SUCCESS) {
+      MemFree(cached);
+      if (T_FrameInit(&falcon->program, &falcon->frame) == EXIT_FAILURE) {
+         Release(falcon);
+         return Error(falcon);
+      }
+      return EXIT_SUCCESS;
+   }
+   errno = 0;
+
+   if (LexInit(falcon, (char *)path) == EXIT_FAILURE || Compile(falcon) == EXIT_FAILURE) {
+      MemFree(cached);
+      Release(falcon);
+      return Error(falcon);
+   }
+
+   // Chyba pri zapise do cache nie je chybou programu
+   if (cached != NULL) {
+      BytecodePublish(&falcon->program, cached, &source);
+      MemFree(cached);
+   }
+
+   if (T_FrameInit(&falcon->program, &falcon->frame) == EXIT_FAILURE) {
+      Release(falcon);
+      return Error(falcon);
+   }
+   return EXIT_SUCCESS;
+}
+
+int FalconCompileFile(T_Falcon *falcon, const char *path)
+{
+   if (falcon == NULL || path == NULL)
+      return INTERNAL_ERROR;
+
+   T_Heap *previous = Enter(falcon);
+   return Leave(previous, CompileFile(falcon, path));
+}
+
+int FalconSave(T_Falcon *falcon, const char *path)
+{
+   if (falcon == NULL || falcon->frame == NULL)
+      return RUNTIME_ERROR;
+
+   /* Program moze bezat z mapovaneho suboru path, ktory zapis skrati.
+      Instrukcie sa preto najprv presunu na haldu.
+   */
+   T_Heap *previous = Enter(falcon);
+   if (T_ProgramUnmap(&falcon->program) == EXIT_FAILURE
+       || BytecodeWrite(&falcon->program, path, NULL) == EXIT_FAILURE)
+      return Leave(previous, Error(falcon));
+   return Leave(previous, EXIT_SUCCESS);
+}
+
+T_Falcon *FalconClone(T_Falcon *falcon)
+{
+   if (falcon == NULL || falcon->frame == NULL)
+      return NULL;
+
+   T_Falcon *clone = FalconNew();
+   if (clone == NULL)
+      return NULL;
+
+   clone->output = falcon->output;
+   clone->output_data = falcon->output_data;
+   clone->input = falcon->input;
+   clone->stats = falcon->stats;
+   clone->budget = falcon->budget;
+   clone->timeout = falcon->timeout;
+   clone->loops = falcon->loops;
+   clone->heap.quota = falcon->heap.quota;
+
+   // Kopia programu patri halde klonu
+   T_Heap *previous = Enter(clone);
+   T_ProgramDelete(&clone->program);
+   if (T_ProgramCopy(&clone->program, &falcon->program) == EXIT_FAILURE
+       || T_FrameInit(&clone->program, &clone->frame) == EXIT_FAILURE)
+   {
+      FalconFree(clone);
+      clone = NULL;
+   }
+   HeapSelect(previous);
+   return clone;
+}
+
+int FalconRun(T_Falcon *falcon)
+{
+   if (falcon == NULL || falcon->frame == NULL)
+      return RUNTIME_ERROR;
+
+   T_Heap *previous = Enter(falcon);
+   return Leave(previous, (Interpret(falcon, 0) == EXIT_SUCCESS) ? EXIT_SUCCESS : Error(falcon));
+}
+
+int FalconStep(T_Falcon *falcon, uint64_t instructions)
+{
+   if (falcon == NULL || falcon->frame == NULL)
+      return RUNTIME_ERROR;
+
+   T_Heap *previous = Enter(falcon);
+   switch (Interpret(falcon, (instructions != 0) ? instructions : 1)) {
+      case EXIT_SUCCESS:
+         return Leave(previous, EXIT_SUCCESS);
+      case INTERPRET_YIELD:
+         return Leave(previous, FALCON_YIELDED);
+      default:
+         return Leave(previous, Error(falcon));
+   }
+}
+
+int FalconReset(T_Falcon *falcon)
+{
+   if (falcon == NULL || falcon->frame == NULL)
+      return RUNTIME_ERROR;
+
+   T_Heap *previous = Enter(falcon);
+   T_FrameDelete(&falcon->program, falcon->frame);
+   falcon->frame = NULL;
+   falcon->suspended = 0;
+   return Leave(previous, (T_FrameInit(&falcon->program, &falcon->frame) == EXIT_SUCCESS) ? EXIT_SUCCESS : Error(falcon));
+}
+
+// Meno premennej musi byt identifikator jazyka
+static int IsName(const char *name)
+{
+   if (name == NULL || !(isalpha((unsigned char)name[0]) || name[0] == '_'))
+      return 0;
+
+   for (const char *c = name + 1; *c != '\0'; c++)
+      if (!(isalnum((unsigned char)*c) || *c == '_'))
+         return 0;
+   return 1;
+}
+
+/* Nastavi premennu na hodnotu value. Pred prekladom ju zapamata v tabulke
+   globals (SynanInit() ju deklaruje), po preklade prepise jej slot v ramci.
+*/
+static int SetVar(T_Falcon *falcon, const char *name, T_Var *value)
+{
+   if (falcon->frame != NULL) {
+      int32_t slot = T_ProgramGlobal(&falcon->program, name);
+      if (slot == NO_SLOT)
+         return UNDEFINED_VARIABLE;
+      return (T_VarShare(&falcon->frame[slot], value) == EXIT_SUCCESS) ? EXIT_SUCCESS : Error(falcon);
+   }
+
+   if (falcon->globals == NULL) {
+      if ((falcon->globals = MemAlloc(sizeof(T_HashTable))) == NULL)
+         return Error(falcon);
+      T_HTableInit(falcon->globals);
+   }
+   return (T_HTableInsert(falcon->globals, (char *)name, value) == EXIT_SUCCESS) ? EXIT_SUCCESS : Error(falcon);
+}
+
+// Premenna zlinkovaneho programu alebo NULL
+static T_Var *GetVar(T_Falcon *falcon, const char *name)
+{
+   if (falcon == NULL || falcon->frame == NULL || name == NULL)
+      return NULL;
+
+   int32_t slot = T_ProgramGlobal(&falcon->program, name);
+   return (slot != NO_SLOT) ? &falcon->frame[slot] : NULL;
+}
+
+int FalconSetNumber(T_Falcon *falcon, const char *name, double value)
+{
+   if (falcon == NULL || !IsName(name))
+      return UNDEFINED_VARIABLE;
+
+   T_Var var;
+   T_VarInit(&var);
+   CDoubleToT_Var(value, &var);
+
+   T_Heap *previous = Enter(falcon);
+   return Leave(previous, SetVar(falcon, name, &var));
+}
+
+int FalconSetString(T_Falcon *falcon, const char *name, const char *value)
+{
+   if (falcon == NULL || !IsName(name))
+      return UNDEFINED_VARIABLE;
+   if (value == NULL)
+      return INTERNAL_ERROR;
+
+   T_Heap *previous = Enter(falcon);
+   T_Var var;
+   T_VarInit(&var);
+   if (CStringToT_String((char *)value, &var.vals.str) == EXIT_FAILURE)
+      return Leave(previous, Error(falcon));
+   var.NID = NID_STRING;
+
+   int rc = SetVar(falcon, name, &var);
+   T_VarDelete(&var);
+   return Leave(previous, rc);
+}
+
+int FalconGetNumber(T_Falcon *falcon, const char *name, double *value)
+{
+   T_Var *var = GetVar(falcon, name);
+   if (var == NULL || var->NID == NID_UNDEF)
+      return UNDEFINED_VARIABLE;
+   if (var->NID != NID_NUMBER || value == NULL)
+      return TYPE_COMPATIBILITY_ERROR;
+
+   *value = NUM_VAL(var);
+   return EXIT_SUCCESS;
+}
+
+int FalconGetString(T_Falcon *falcon, const char *name, const char **value)
+{
+   T_Var *var = GetVar(falcon, name);
+   if (var == NULL || var->NID == NID_UNDEF)
+      return UNDEFINED_VARIABLE;
+   if (var->NID != NID_STRING || value == NULL)
+      return TYPE_COMPATIBILITY_ERROR;
+
+   // Spojenie lana alokuje, buffer patri halde instancie
+   T_Heap *previous = Enter(falcon);
+   if (T_VarFlatten(var) == EXIT_FAILURE)
+      return Leave(previous, Error(falcon));
+   *value = (var->vals.str.data != NULL) ? var->vals.str.data : "";
+   return Leave(previous, EXIT_SUCCESS);
+}
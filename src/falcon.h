@@ -0,0 +1,114 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+//  Falcon Interpreter
+//
+//  for Formal Languages and Compilers 2012/2013
+//  by Varga Tomas, Vojvoda Jakub, Nesvadba Tomas, Spanko Jaroslav, Warzel Adam
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef FALCON_H
+#define FALCON_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "codes.h"
+
+// Only the Falcon* functions are exported from libfalcon.so, see Makefile
+#if defined(__GNUC__)
+#define FALCON_API __attribute__((visibility("default")))
+#else
+#define FALCON_API
+#endif
+
+/* Embedding API of libfalcon.
+
+   An instance (T_Falcon) compiles one script and runs it any number of
+   times. Instances share nothing, each thread may use its own. Functions
+   returning int return 0 on success or an error code from codes.h, the
+   same value falcon-interpreter exits with.
+
+      T_Falcon *falcon = FalconNew();
+      FalconSetNumber(falcon, "limit", 10.0);   // declares limit
+      FalconCompile(falcon, source, strlen(source));
+      FalconRun(falcon);
+      FalconGetNumber(falcon, "result", &result);
+      FalconFree(falcon);
+*/
+typedef struct T_Context T_Falcon;
+
+// Receives everything print() writes, text is not terminated by '\0'
+typedef void (*T_FalconOutput)(void *data, const char *text, size_t length);
+
+FALCON_API T_Falcon *FalconNew(void);
+FALCON_API void FalconFree(T_Falcon *falcon);
+
+// Redirects print() of the instance, NULL restores stdout
+FALCON_API void FalconSetOutput(T_Falcon *falcon, T_FalconOutput output, void *data);
+// Stream input() of the instance reads lines from, NULL restores stdin
+FALCON_API void FalconSetInput(T_Falcon *falcon, FILE *fd);
+/* Bounds every FalconRun(): it fails with LIMIT_EXCEEDED after executing
+   about instructions instructions or after microseconds of wall-clock
+   time. Both are checked on every loop iteration, so a run stops at most
+   one iteration (plus a few milliseconds of clock resolution) late.
+   0 disables a limit. Runs without limits pay nothing for them.
+*/
+FALCON_API void FalconSetLimits(T_Falcon *falcon, uint64_t instructions, uint64_t microseconds);
+/* Bounds memory the instance holds (program, variables, strings) to bytes,
+   0 for no limit. An allocation over the quota fails the call which made
+   it with MEMORY_EXCEEDED, the instance may be reset or freed afterwards.
+*/
+FALCON_API void FalconSetMemory(T_Falcon *falcon, size_t bytes);
+// Bytes the instance holds now and the most it has ever held
+FALCON_API void FalconMemory(T_Falcon *falcon, size_t *live, size_t *peak);
+// Prints optimizer statistics of every compilation to fd, NULL disables them
+FALCON_API void FalconSetStats(T_Falcon *falcon, FILE *fd);
+
+/* Compiles a script from memory or from a file. A file may also hold
+   a program saved by FalconSave(). Compiled files are cached in the
+   directory named by FALCON_CACHE_DIR, unless variables were set before
+   compilation or statistics are enabled, which only a compilation prints.
+   Compiling again replaces the previous program.
+*/
+FALCON_API int FalconCompile(T_Falcon *falcon, const char *source, size_t length);
+FALCON_API int FalconCompileFile(T_Falcon *falcon, const char *path);
+// Saves the compiled program as a .fbc file
+FALCON_API int FalconSave(T_Falcon *falcon, const char *path);
+
+/* Creates an instance with a copy of the compiled program of falcon and
+   the same output, input, statistics, limits and memory quota. Its variables start
+   from their values after compilation. The copy can run in another
+   thread while falcon runs. Returns NULL on failure.
+*/
+FALCON_API T_Falcon *FalconClone(T_Falcon *falcon);
+
+// Runs the program; variables keep their values until FalconReset()
+FALCON_API int FalconRun(T_Falcon *falcon);
+
+/* Runs about instructions instructions of the program and returns
+   FALCON_YIELDED if it has not finished yet. The next FalconStep() or
+   FalconRun() continues where it stopped, so one thread can interleave
+   many instances. A slice ends on a loop iteration: straight code between
+   two iterations always runs whole. Limits of FalconSetLimits() apply to
+   the whole run, not to one slice.
+*/
+#define FALCON_YIELDED -1
+FALCON_API int FalconStep(T_Falcon *falcon, uint64_t instructions);
+
+// Restores all variables of the program to their values after compilation
+// and cancels a run stopped by FalconStep()
+FALCON_API int FalconReset(T_Falcon *falcon);
+
+/* Variables of the script. Before compilation a set declares the variable,
+   so the script may read it; afterwards only variables the script uses
+   exist. A string from FalconGetString() is valid until the variable
+   changes.
+*/
+FALCON_API int FalconSetNumber(T_Falcon *falcon, const char *name, double value);
+FALCON_API int FalconSetString(T_Falcon *falcon, const char *name, const char *value);
+FALCON_API int FalconGetNumber(T_Falcon *falcon, const char *name, double *value);
+FALCON_API int FalconGetString(T_Falcon *falcon, const char *name, const char **value);
+
+#endif
@@ -10,10 +10,14 @@
 #include <stdlib.h>
 #include <errno.h>
 
+#include "alloc.h"
 #include "macros.h"
 #include "codes.h"
 
-int itoa (int num, char *str, int base)
+/* Prevedie num na retazec v sustave base. Buffer *str sa zvacsi
+   MemRealloc()om, volajuci dostane novy ukazovatel.
+*/
+int itoa (int num, char **str, int base)
 {
    PTR_CHECK(str);
 
@@ -26,16 +30,16 @@ int itoa (int num, char *str, int base)
    if (num == 0)
       len = 1;
 
-   char *tmp = realloc(str, sizeof(char)*(len+1));
+   char *tmp = MemRealloc(*str, sizeof(char)*(len+1));
    PTR_CHECK(tmp);
-   str = tmp;
+   *str = tmp;
 
    for (int i = len; i > 0; i--) {
       c = '0' + num % base;
       num /= base;
-      str[i-1] = c;
+      tmp[i-1] = c;
    }
-   str[len] = '\0';
+   tmp[len] = '\0';
 
    return EXIT_SUCCESS;
 }
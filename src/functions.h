@@ -12,6 +12,6 @@
 
 #define DECIMAL_BASE 10
 
-int itoa (int num, char *str, int base);
+int itoa (int num, char **str, int base);
 
 #endif
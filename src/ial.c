@@ -8,9 +8,10 @@
 ///////////////////////////////////////////////////////////////////////////////
 
 #include <errno.h>
-#include <string.h> // strcpy()
+#include <string.h> // strcmp()
 #include <stdlib.h> // malloc()
 
+#include "alloc.h"
 #include "codes.h"
 #include "types.h"
 #include "ial.h"
@@ -20,7 +21,7 @@
 void computeJumps (T_String *substring, int *char_jumps)
 {
    int i, k;
-   int length = substring->length;
+   int length = STRING_LENGTH(substring);
 
    for (i = 0; i <= MAX_CHARS; i++)
       char_jumps[i] = length;
@@ -41,10 +42,12 @@ int Find(T_Var *str, T_Var *sub_str, T_Var *write_var)
       errno = TYPE_COMPATIBILITY_ERROR;
       return EXIT_FAILURE;
    }
+   CALL_CHECK(T_VarFlatten(str));
+   CALL_CHECK(T_VarFlatten(sub_str));
 
-   int j = sub_str->vals.str.length - 1;
-   int k = sub_str->vals.str.length - 1;
-   int q = str->vals.str.length - 1;
+   int j = STRING_LENGTH(&sub_str->vals.str) - 1;
+   int k = STRING_LENGTH(&sub_str->vals.str) - 1;
+   int q = STRING_LENGTH(&str->vals.str) - 1;
    int char_jumps[MAX_CHARS];
    int l;
 
@@ -58,12 +61,11 @@ int Find(T_Var *str, T_Var *sub_str, T_Var *write_var)
       else {
          l = str->vals.str.data[j];
          j += char_jumps[l] + 1;
-         k = sub_str->vals.str.length - 1;
+         k = STRING_LENGTH(&sub_str->vals.str) - 1;
       }
    }
    if (k < 0) {
-      write_var->NID = 2.0;
-      write_var->vals.d_val = (double)(j + 1);
+      CDoubleToT_Var((double)(j + 1), write_var);
    }
    else
       return EXIT_FAILURE;
@@ -80,14 +82,17 @@ int Sort(T_Var *read_str, T_Var *write_str)
    // Numeric identificator of a type is string
    if (read_str->NID != NID_STRING)
       return TYPE_COMPATIBILITY_ERROR;
+   // Triedi sa v plochom buffri, aj ked write_str == read_str
+   CALL_CHECK(T_VarFlatten(read_str));
 
    int i, j;
    char pom;
-   int step = read_str->vals.str.length / 2 - 1;
-   int length = read_str->vals.str.length - 1;
+   int step = STRING_LENGTH(&read_str->vals.str) / 2 - 1;
+   int length = STRING_LENGTH(&read_str->vals.str) - 1;
 
    // write_str remains same as on input
-   strcpy(write_str->vals.str.data, read_str->vals.str.data);
+   if (write_str != read_str)
+      CALL_CHECK(T_VarCopy(write_str, read_str));
 
    while (step > 0) {
       for (i = step; i <= length; i++) {
@@ -103,13 +108,12 @@ int Sort(T_Var *read_str, T_Var *write_str)
    }
    // Fill structure T_Var
    write_str->NID = NID_STRING;
-   write_str->vals.str.length = read_str->vals.str.length;
 
    return 0;
 }
 
 /* Inicializacia hash tabulky.
-   Pred inicializaciou -- T_HashTable *table = malloc(sizeof(T_HashTable));
+   Pred inicializaciou -- T_HashTable *table = MemAlloc(sizeof(T_HashTable));
 */
 int T_HTableInit(T_HashTable *table)
 {
@@ -152,12 +156,12 @@ int T_HTableInsert(T_HashTable *table, char *string, T_Var *var)
    if (new_item != NULL) // Update existing variable
       return T_VarCopy(new_item->var, var);
 
-   new_item = malloc(sizeof(struct T_HashItem));
+   new_item = POOL_NEW(T_HashItem);
    PTR_CHECK(new_item);
 
-   T_String *new_string = malloc(sizeof(T_String));
+   T_String *new_string = POOL_NEW(T_String);
    if (new_string == NULL) {
-      free(new_item);
+      POOL_DELETE(T_HashItem, new_item);
       errno = INTERNAL_ERROR;
       return EXIT_FAILURE;
    }
@@ -166,12 +170,13 @@ int T_HTableInsert(T_HashTable *table, char *string, T_Var *var)
    CALL_CHECK(CStringToT_String(string, new_string));
 
    new_item->string = new_string;
+   new_item->var = NULL;
 
    if (var != NULL) {
-      T_Var *new_var = malloc(sizeof(T_Var));
+      T_Var *new_var = POOL_NEW(T_Var);
       if (new_var == NULL) {
-         free(new_item);
-         free(new_string);
+         POOL_DELETE(T_HashItem, new_item);
+         POOL_DELETE(T_String, new_string);
          errno = INTERNAL_ERROR;
          return EXIT_FAILURE;
       }
@@ -218,7 +223,11 @@ void T_HTableDelete (T_HashTable *table)
       item = (*table)[i];
       while ( (*table)[i] != NULL ) {
          (*table)[i] = (*table)[i]->next;
-         free(item);
+         T_StringDelete(item->string);
+         POOL_DELETE(T_String, item->string);
+         T_VarDelete(item->var);
+         POOL_DELETE(T_Var, item->var);
+         POOL_DELETE(T_HashItem, item);
          item = (*table)[i];
       }
    }
@@ -8,53 +8,98 @@
 ///////////////////////////////////////////////////////////////////////////////
 
 #include <stdlib.h>
+#include <string.h>
 #include <errno.h>
+#include <stdint.h>
 
-#include "codes.h"
+#include "batch.h"
 #include "debug.h"
-#include "interpret.h"
-#include "lex.h"
-#include "macros.h"
-#include "synan.h"
+#include "falcon.h"
+
+// Kladne cele cislo argumentu prikazovej riadky, najviac max
+static int Number(const char *arg, unsigned long long max, unsigned long long *value)
+{
+   char *end;
+   errno = 0;
+   *value = strtoull(arg, &end, 10);
+   return (errno == 0 && *arg != '\0' && *arg != '-' && *end == '\0' && *value >= 1 && *value <= max);
+}
 
 int main(int argc, char *argv[])
 {
    DebugInit();
 
-   if (argc != 2)
-      return RUNTIME_ERROR;
-
-   CALL_CHECK(LexInit(argv[1]));
-
-   T_List inst_list;
-   CALL_CHECK(T_ListInit(&inst_list));
-
-   T_AllocList alloc_list;
-   CALL_CHECK(T_AllocListInit(&alloc_list));
-
-   T_LabelList lbl_list;
-   CALL_CHECK(T_LabelListInit(&lbl_list));
-
-   if (SynanInit(&inst_list, &alloc_list, &lbl_list) == EXIT_FAILURE) {
-      LexFinish();
-      return errno;
+   /* falcon-interpreter [limity] [--stats] [--compile vystup.fbc] subor
+      falcon-interpreter [limity] --batch manifest|adresar [--threads N]
+      falcon-interpreter [limity] --jobs N subor < vstup
+      limity: --budget instrukcii --timeout ms --memory MB
+   */
+   int print_stats = 0;
+   char *output = NULL;
+   char *file = NULL;
+   char *batch = NULL;
+   unsigned long long threads = 0;
+   unsigned long long jobs = 0;
+   unsigned long long budget = 0;
+   unsigned long long timeout = 0;
+   unsigned long long memory = 0;
+   for (int i = 1; i < argc; i++) {
+      if (strcmp(argv[i], "--stats") == 0)
+         print_stats = 1;
+      else if (strcmp(argv[i], "--compile") == 0 && i + 1 < argc)
+         output = argv[++i];
+      else if (strcmp(argv[i], "--batch") == 0 && i + 1 < argc)
+         batch = argv[++i];
+      else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+         if (!Number(argv[++i], 1024, &threads))
+            return RUNTIME_ERROR;
+      }
+      else if (strcmp(argv[i], "--jobs") == 0 && i + 1 < argc) {
+         if (!Number(argv[++i], 1024, &jobs))
+            return RUNTIME_ERROR;
+      }
+      else if (strcmp(argv[i], "--budget") == 0 && i + 1 < argc) {
+         if (!Number(argv[++i], UINT64_MAX, &budget))
+            return RUNTIME_ERROR;
+      }
+      else if (strcmp(argv[i], "--timeout") == 0 && i + 1 < argc) {
+         if (!Number(argv[++i], UINT64_MAX / 1000, &timeout))
+            return RUNTIME_ERROR;
+      }
+      else if (strcmp(argv[i], "--memory") == 0 && i + 1 < argc) {
+         if (!Number(argv[++i], SIZE_MAX >> 20, &memory))
+            return RUNTIME_ERROR;
+      }
+      else if (file == NULL)
+         file = argv[i];
+      else
+         return RUNTIME_ERROR;
    }
-
-   DEBUG_MAIN_SYNAN;
-   if (Synan() == EXIT_FAILURE) {
-      LexFinish();
-      SynanFinish(&inst_list);
-      return errno;
+   T_BatchLimits limits = { budget, timeout * 1000, (size_t)memory << 20 };
+   if (batch != NULL) {
+      if (file != NULL || jobs > 0 || output != NULL || print_stats)
+         return RUNTIME_ERROR;
+      return Batch(batch, threads, &limits, stdout, stderr);
    }
-   DEBUG_MAIN_SYNAN_END;
+   // --threads plati len pre --batch
+   if (file == NULL || threads > 0)
+      return RUNTIME_ERROR;
+   if (jobs > 0)
+      return (output == NULL && !print_stats) ? Jobs(file, jobs, &limits, stdin, stdout) : RUNTIME_ERROR;
 
-   if (Interpret(&inst_list, &lbl_list) == EXIT_FAILURE) {
-     LexFinish();
-     SynanFinish(&inst_list);
-     return errno;
-   }
+   T_Falcon *falcon = FalconNew();
+   if (falcon == NULL)
+      return INTERNAL_ERROR;
+   if (print_stats)
+      FalconSetStats(falcon, stderr);
+   FalconSetLimits(falcon, limits.budget, limits.microseconds);
+   FalconSetMemory(falcon, limits.memory);
+
+   // --compile len ulozi program, nevykonava ho
+   int rc = FalconCompileFile(falcon, file);
+   if (rc == EXIT_SUCCESS)
+      rc = (output != NULL) ? FalconSave(falcon, output) : FalconRun(falcon);
 
-   LexFinish();
-   SynanFinish(&inst_list);
-   return EXIT_SUCCESS;
+   FalconFree(falcon);
+   return rc;
 }
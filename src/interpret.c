@@ -7,10 +7,14 @@
 //
 ///////////////////////////////////////////////////////////////////////////////
 
+#define _POSIX_C_SOURCE 200809L // clock_gettime()
+
 #include <math.h>
 #include <errno.h>
 #include <string.h>
+#include <time.h>
 
+#include "alloc.h"
 #include "interpret.h"
 #include "macros.h"
 #include "types.h"
@@ -25,7 +29,150 @@
 int T_StringFill(T_String *str, T_Var var);
 void OperationPrint(int op);
 int RelType(T_Var arg1, T_Var arg2);
-int Jump(T_List *list, T_LabelList *lbl_list, T_Var *var);
+static int Relation(int IID, T_Var *a, T_Var *b, int *result);
+
+/* Vyber sposobu dispatchu instrukcii v Interpret(). Ak to prekladac
+   dovoli (GCC labels as values, bez -std=c99 -pedantic), kazda instrukcia
+   skace na dalsiu cez vlastny neprimy skok z tabulky dispatch. Inac sa
+   pouzije jeden switch. Prepnutie: make DISPATCH=threaded|switch.
+   NEXT a JUMP su prikazy, pouzivaju sa len na urovni bloku.
+*/
+#if defined(__GNUC__) && !defined(__STRICT_ANSI__) && !defined(SWITCH_DISPATCH)
+   #define THREADED_DISPATCH
+#endif
+
+#ifdef THREADED_DISPATCH
+   #define DISPATCH goto *dispatch[current->IID];
+   #define CASE(iid) L_##iid
+   #define NEXT current++; goto *dispatch[current->IID]
+   #define JUMP(index) current = code + (index); goto *dispatch[current->IID]
+   #define REDISPATCH goto *dispatch[current->IID]
+#else
+   #define DISPATCH for (;;) switch (current->IID)
+   #define CASE(iid) case iid
+   #define NEXT current++; continue
+   #define JUMP(index) current = code + (index); continue
+   #define REDISPATCH continue
+#endif
+
+// Operandy aktualnej instrukcie v ramci
+#define ARG1 (frame + current->arg1)
+#define ARG2 (frame + current->arg2)
+#define ARG3 (frame + current->arg3)
+
+/* Specializuje aktualnu instrukciu na iid. Program z .fbc bezi z mapovanych
+   stranok len do prveho specializovania, potom z kopie na halde instancie
+   (T_ProgramUnmap()). Ak sa kopia nepodari, instrukcia zostane genericka.
+*/
+#define QUICKEN(iid) do { \
+   if (program->image != NULL) { \
+      size_t pc = (size_t)(current - code); \
+      if (T_ProgramUnmap(program) == EXIT_SUCCESS) { \
+         code = program->code; \
+         current = code + pc; \
+      } \
+   } \
+   if (program->image == NULL) \
+      current->IID = (iid); \
+} while (0)
+
+/* Zapise cislo do premennej, retazec v nej uvolni. val sa vyhodnoti
+   skor, nez sa zmeni sub, moze teda citat aj samotnu premennu.
+*/
+#define NUM_RESULT(var, val) do { \
+   double num_result = (val); \
+   if ((var)->NID == NID_STRING) \
+      T_VarDelete(var); \
+   (var)->NID = NID_NUMBER; \
+   (var)->sub = SUB_NONE; \
+   (var)->vals.d_val = num_result; \
+} while (0)
+
+// Zapise cele cislo s |val| < INT_LIMIT do vals.i_val
+#define INT_RESULT(var, val) do { \
+   int64_t int_result = (val); \
+   if ((var)->NID == NID_STRING) \
+      T_VarDelete(var); \
+   (var)->NID = NID_NUMBER; \
+   (var)->sub = SUB_INT; \
+   (var)->vals.i_val = int_result; \
+} while (0)
+// Vysledok celociselnej operacie zostava celym cislom, ak ho double vyjadri presne
+#define IN_INT_RANGE(val) ((val) > -(int64_t)INT_LIMIT && (val) < (int64_t)INT_LIMIT)
+
+#define IS_INT(var) ((var)->NID == NID_NUMBER && (var)->sub == SUB_INT)
+// Rope sa pred citanim bajtov retazca spoji, viz T_VarFlatten()
+#define FLATTEN(var) do { \
+   if (IS_ROPE(var) && T_VarFlatten(var) == EXIT_FAILURE) \
+      return EXIT_FAILURE; \
+} while (0)
+// Celociselna hodnota cisla (index, pocet opakovani)
+#define INT_VAL(var) ((var)->sub == SUB_INT ? (var)->vals.i_val : (int64_t)(var)->vals.d_val)
+
+/* Hodiny terminu behu, citaju sa pri kazdom prechode cyklom. Jeden prechod
+   moze trvat dlho (napr. retazec z milionov znakov), kontrola raz za niekolko
+   prechodov by termin prekrocila mnohonasobne. Hrube hodiny su volanie vDSO
+   bez systemoveho volania, ich rozlisenie (tik jadra) termin predlzi najviac
+   o niekolko milisekund.
+*/
+#ifdef CLOCK_MONOTONIC_COARSE
+#define DEADLINE_CLOCK CLOCK_MONOTONIC_COARSE
+#else
+#define DEADLINE_CLOCK CLOCK_MONOTONIC
+#endif
+
+static uint64_t Now(void)
+{
+   struct timespec now;
+   clock_gettime(DEADLINE_CLOCK, &now);
+   return (uint64_t)now.tv_sec * 1000000000 + now.tv_nsec;
+}
+
+/* Prepise spatne skoky programu na IID_LOOP (checked != 0) alebo spat na
+   IID_JUMP. Dozadu skace len IID_JUMP, podmienene skoky Optimize() dozadu
+   nepresmeruje, takze kazdy cyklus prejde aspon jednou IID_LOOP.
+   Program z mapovaneho .fbc sa pred prvym prepisom presunie na haldu.
+*/
+static int MarkLoops(T_Program *program, int checked)
+{
+   for (uint32_t i = 0; i < program->size; i++) {
+      T_Code *code = &program->code[i];
+      int IID = code->IID;
+      if (checked && IID == IID_JUMP && code->arg1 != NO_TARGET && (uint32_t)code->arg1 <= i)
+         IID = IID_LOOP;
+      else if (!checked && IID == IID_LOOP)
+         IID = IID_JUMP;
+      else
+         continue;
+
+      CALL_CHECK(T_ProgramUnmap(program));
+      program->code[i].IID = IID;
+   }
+   return EXIT_SUCCESS;
+}
+
+/* Vrati genericku instrukciu, z ktorej Interpret() specializovanim alebo
+   MarkLoops() vytvoril IID. BytecodeWrite() tak zapise program v tvare,
+   v akom vysiel z prekladu, aj ked uz bezal.
+*/
+int GenericIID(int IID)
+{
+   switch (IID) {
+      case IID_PLUS_NUM: case IID_PLUS_STR: case IID_PLUS_INT: return IID_PLUS;
+      case IID_DIFF_NUM: case IID_DIFF_INT: return IID_DIFF;
+      case IID_MUL_NUM: case IID_MUL_INT: return IID_MUL;
+      case IID_DIV_NUM: case IID_DIV_INT: return IID_DIV;
+      case IID_PWR_NUM: return IID_PWR;
+      case IID_BR_STR_EQUAL: return IID_BR_EQUAL;
+      case IID_BR_STR_UNEQUAL: return IID_BR_UNEQUAL;
+      case IID_LOOP: return IID_JUMP;
+   }
+   if (IID >= IID_BR_NUM_EQUAL && IID <= IID_BR_NUM_BIGGER)
+      return IID_BR_EQUAL + (IID - IID_BR_NUM_EQUAL);
+   if (IID >= IID_BR_INT_EQUAL && IID <= IID_BR_INT_BIGGER)
+      return IID_BR_EQUAL + (IID - IID_BR_INT_EQUAL);
+   return IID;
+}
 
 // T_Instr --------------------------------------------------------------------
 int T_InstrInit(T_Instr *instr)
@@ -37,6 +184,7 @@ int T_InstrInit(T_Instr *instr)
    instr->arg1 = NULL;
    instr->arg2 = NULL;
    instr->arg3 = NULL;
+   instr->target = NO_TARGET;
 
    return EXIT_SUCCESS;
 }
@@ -45,9 +193,9 @@ void T_InstrDelete(T_Instr *instr)
 {
    DEBUG_T_INSTRDELETE;
    if (instr !=NULL) {
-      free(instr->arg1);
-      free(instr->arg2);
-      free(instr->arg3);
+      MemFree(instr->arg1);
+      MemFree(instr->arg2);
+      MemFree(instr->arg3);
    }
 }
 
@@ -59,79 +207,195 @@ int T_InstrSet(T_Instr *instr, int IID, T_Var *arg1, T_Var *arg2, T_Var *arg3)
    instr->arg1 = arg1;
    instr->arg2 = arg2;
    instr->arg3 = arg3;
+   instr->target = NO_TARGET;
 
    return EXIT_SUCCESS;
 }
 
-int Interpret(T_List *list, T_LabelList *lbl_list)
+/* Vykona program kontextu nad jeho ramcom (viz T_FrameInit()). Operandy
+   instrukcii su indexy slotov ramca, takze jeden program moze bezat vo viac
+   ramcoch. Interpret pouziva len stav kontextu, rozne kontexty mozu bezat
+   v roznych vlaknach.
+
+   Limity behu (ctx->budget, ctx->timeout) sa kontroluju len v IID_LOOP,
+   na ktore sa spatne skoky prepisu, kym su limity nastavene. Beh bez
+   limitov vykonava ten isty kod ako predtym. Kazdy prechod cyklom odpocita
+   z rozpoctu dlzku cyklu v instrukciach a pri nastavenom termine precita
+   cas. Po prekroceni skonci chybou LIMIT_EXCEEDED.
+
+   slice != 0 obmedzi jedno volanie rovnakym pocitanim na priblizne slice
+   instrukcii. Po jeho vycerpani Run() ulozi do kontextu index hlavicky
+   cyklu a vrati INTERPRET_YIELD, dalsie volanie pokracuje odtial. Rozpocet
+   aj termin plati pre cely beh, nie pre jeden usek.
+*/
+static int Run(T_Context *ctx, uint64_t slice)
 {
-   DEBUG_INTERPRET(list);
-   list->actual = list->first;
-   while (list->actual != NULL) {
-      T_Instr *current = list->actual->data;
-      switch (current->IID) {
+   PTR_CHECK(ctx);
+   T_Program *program = &ctx->program;
+   T_Var *frame = ctx->frame;
+   PTR_CHECK(frame);
+
+   DEBUG_INTERPRET(program);
+   int limited = (ctx->budget != 0 || ctx->timeout != 0 || slice != 0);
+   if (limited != ctx->loops) {
+      CALL_CHECK(MarkLoops(program, limited));
+      ctx->loops = limited;
+   }
+
+   // Novy beh, pozastaveny pokracuje so svojim rozpoctom a terminom
+   if (!ctx->suspended) {
+      ctx->pc = 0;
+      ctx->spent = 0;
+      ctx->deadline = (ctx->timeout != 0) ? Now() + ctx->timeout : 0;
+   }
+   ctx->suspended = 0;
+
+   // left: instrukcie do konca useku alebo rozpoctu, podla toho co skor
+   uint64_t budget = (ctx->budget != 0) ? ctx->budget - ctx->spent : UINT64_MAX;
+   uint64_t left = (slice != 0 && slice < budget) ? slice : budget;
+   uint64_t start = left;
+   uint64_t deadline = ctx->deadline;
+
+   T_Code *code = program->code;
+   T_Code *current = code + ctx->pc;
+
+#ifdef THREADED_DISPATCH
+   static void *dispatch[IID_COUNT] = {
+      [IID_NOP] = &&L_IID_NOP,           [IID_COPY] = &&L_IID_COPY,
+      [IID_LABEL] = &&L_IID_LABEL,       [IID_JUMP] = &&L_IID_JUMP,
+      [IID_BRATRUE] = &&L_IID_BRATRUE,   [IID_BRAFAL] = &&L_IID_BRAFAL,
+      [IID_BRANTRUE] = &&L_IID_BRANTRUE, [IID_BRANFAL] = &&L_IID_BRANFAL,
+      [IID_PLUS] = &&L_IID_PLUS,         [IID_DIFF] = &&L_IID_DIFF,
+      [IID_MUL] = &&L_IID_MUL,           [IID_DIV] = &&L_IID_DIV,
+      [IID_PWR] = &&L_IID_PWR,           [IID_CUT] = &&L_IID_CUT,
+      [IID_EQUAL] = &&L_IID_EQUAL,       [IID_UNEQUAL] = &&L_IID_UNEQUAL,
+      [IID_BEQUAL] = &&L_IID_BEQUAL,     [IID_SMEQUAL] = &&L_IID_SMEQUAL,
+      [IID_SMALLER] = &&L_IID_SMALLER,   [IID_BIGGER] = &&L_IID_BIGGER,
+      [IID_INPUT] = &&L_IID_INPUT,       [IID_NUMERIC] = &&L_IID_NUMERIC,
+      [IID_PRINT] = &&L_IID_PRINT,       [IID_TYPEOF] = &&L_IID_TYPEOF,
+      [IID_LEN] = &&L_IID_LEN,           [IID_FIND] = &&L_IID_FIND,
+      [IID_SORT] = &&L_IID_SORT,         [IID_HALT] = &&L_IID_HALT,
+      [IID_PLUS_NUM] = &&L_IID_PLUS_NUM, [IID_PLUS_STR] = &&L_IID_PLUS_STR,
+      [IID_DIFF_NUM] = &&L_IID_DIFF_NUM, [IID_MUL_NUM] = &&L_IID_MUL_NUM,
+      [IID_DIV_NUM] = &&L_IID_DIV_NUM,   [IID_PWR_NUM] = &&L_IID_PWR_NUM,
+      [IID_BR_EQUAL] = &&L_IID_BR_EQUAL,             [IID_BR_UNEQUAL] = &&L_IID_BR_UNEQUAL,
+      [IID_BR_BEQUAL] = &&L_IID_BR_BEQUAL,           [IID_BR_SMEQUAL] = &&L_IID_BR_SMEQUAL,
+      [IID_BR_SMALLER] = &&L_IID_BR_SMALLER,         [IID_BR_BIGGER] = &&L_IID_BR_BIGGER,
+      [IID_BR_NUM_EQUAL] = &&L_IID_BR_NUM_EQUAL,     [IID_BR_NUM_UNEQUAL] = &&L_IID_BR_NUM_UNEQUAL,
+      [IID_BR_NUM_BEQUAL] = &&L_IID_BR_NUM_BEQUAL,   [IID_BR_NUM_SMEQUAL] = &&L_IID_BR_NUM_SMEQUAL,
+      [IID_BR_NUM_SMALLER] = &&L_IID_BR_NUM_SMALLER, [IID_BR_NUM_BIGGER] = &&L_IID_BR_NUM_BIGGER,
+      [IID_BR_STR_EQUAL] = &&L_IID_BR_STR_EQUAL,     [IID_BR_STR_UNEQUAL] = &&L_IID_BR_STR_UNEQUAL,
+      [IID_PLUS_INT] = &&L_IID_PLUS_INT, [IID_DIFF_INT] = &&L_IID_DIFF_INT,
+      [IID_MUL_INT] = &&L_IID_MUL_INT,   [IID_DIV_INT] = &&L_IID_DIV_INT,
+      [IID_LOOP] = &&L_IID_LOOP,         [IID_APPEND] = &&L_IID_APPEND,
+      [IID_BR_INT_EQUAL] = &&L_IID_BR_INT_EQUAL,     [IID_BR_INT_UNEQUAL] = &&L_IID_BR_INT_UNEQUAL,
+      [IID_BR_INT_BEQUAL] = &&L_IID_BR_INT_BEQUAL,   [IID_BR_INT_SMEQUAL] = &&L_IID_BR_INT_SMEQUAL,
+      [IID_BR_INT_SMALLER] = &&L_IID_BR_INT_SMALLER, [IID_BR_INT_BIGGER] = &&L_IID_BR_INT_BIGGER
+   };
+#endif
+
+   DISPATCH {
 
       // No Operation  -----------------------------------------------------------------------------------------------
-      case IID_NOP: break;
+      CASE(IID_NOP):
+      CASE(IID_BRATRUE):
+      CASE(IID_BRANTRUE):
+      CASE(IID_BRANFAL):
+         NEXT;
 
       // Priradenie --------------------------------------------------------------------------------------------------
-      case IID_COPY:
+      CASE(IID_COPY):
          DEBUG_INTERPRET_COPY(current);
-         if (current->arg2->NID == NID_UNDEF) {
+         if (ARG2->NID == NID_UNDEF) {
             errno = UNDEFINED_VARIABLE;
             return EXIT_FAILURE;
          }
-         T_VarCopy(current->arg1, current->arg2);
-      break;
+         CALL_CHECK(T_VarShare(ARG1, ARG2));
+      NEXT;
 
       // Navestia ----------------------------------------------------------------------------------------------------
-      case IID_LABEL: break;
+      CASE(IID_LABEL): NEXT;
 
       // Skoci na nasledujuce navestie -------------------------------------------------------------------------------
-      // IID: IID_JUMP; arg1: NID = NID_STRING, str.data = meno labelu
-      case IID_JUMP:
+      // IID: IID_JUMP; arg1 = index instrukcie za navestim (viz Link())
+      CASE(IID_JUMP):
          DEBUG_INTERPRET_JUMP(current);
-         CALL_CHECK(Jump(list, lbl_list, current->arg1));
-      break;
+         if (current->arg1 == NO_TARGET) {
+            errno = INTERNAL_ERROR;
+            return EXIT_FAILURE;
+         }
+         JUMP(current->arg1);
+
+      // Spatny skok s kontrolou limitov behu ----------------------------------------------------------------------------
+      // IID: IID_LOOP; arg1 = index instrukcie za navestim, nie vacsi ako index IID_LOOP
+      CASE(IID_LOOP): {
+         uint64_t length = (uint64_t)(current - code) - current->arg1 + 1;
+         if (length >= left) {
+            if (length >= budget - (start - left)) {
+               errno = LIMIT_EXCEEDED;
+               return EXIT_FAILURE;
+            }
+            // Koniec useku, skok sa vykona az pri dalsom volani
+            ctx->spent += start - left + length;
+            ctx->pc = current->arg1;
+            ctx->suspended = 1;
+            return INTERPRET_YIELD;
+         }
+         left -= length;
+
+         if (deadline != 0 && Now() >= deadline) {
+            errno = LIMIT_EXCEEDED;
+            return EXIT_FAILURE;
+         }
+         JUMP(current->arg1);
+      }
 
       // Skoci na navestie ak neplati podmienka -------------------------------------------------------------------------
-      case IID_BRAFAL:
+      CASE(IID_BRAFAL):
          DEBUG_INTERPRET_BRAFAL(current);
-         if ((current->arg1->NID == NID_BOOL && current->arg1->vals.b_val == FALSE)
-             || (current->arg1->NID == NID_NIL)
-             || (current->arg1->NID == NID_NUMBER && current->arg1->vals.d_val == 0.0)
-             || (current->arg1->NID == NID_STRING && (strcmp(current->arg1->vals.str.data, "") == 0)))
+         if ((ARG1->NID == NID_BOOL && ARG1->vals.b_val == FALSE)
+             || (ARG1->NID == NID_NIL)
+             || (ARG1->NID == NID_NUMBER && NUM_VAL(ARG1) == 0.0)
+             || (ARG1->NID == NID_STRING && T_VarFirstChar(ARG1) == '\0'))
          {
-            Jump(list, lbl_list, current->arg2);
+            if (current->arg2 == NO_TARGET) {
+               errno = INTERNAL_ERROR;
+               return EXIT_FAILURE;
+            }
+            JUMP(current->arg2);
          }
-      break;
+      NEXT;
 
       //  + (plus) ----------------------------------------------------------------------------------------------------
-      case IID_PLUS:
+      CASE(IID_PLUS):
          DEBUG_INTERPRET_PLUS(current);
-         if (current->arg3 == NULL) {
-           if (current->arg1->NID == NID_UNDEF || current->arg2->NID == NID_UNDEF) {
+         if (current->arg3 == NO_SLOT) {
+           if (ARG1->NID == NID_UNDEF || ARG2->NID == NID_UNDEF) {
             errno = UNDEFINED_VARIABLE;
             return EXIT_FAILURE;
            }
             // Soucet cisel vysledok
-            if (current->arg1->NID == NID_NUMBER && current->arg2->NID == NID_NUMBER) {
-               current->arg1->vals.d_val += current->arg2->vals.d_val;
+            if (ARG1->NID == NID_NUMBER && ARG2->NID == NID_NUMBER) {
+               CDoubleToT_Var(NUM_VAL(ARG1) + NUM_VAL(ARG2), ARG1);
             }
             // Konkatenacia retazca
-            else if (current->arg1->NID == NID_STRING) {
-               if (current->arg2->NID == NID_STRING) {
-                  CALL_CHECK(T_StringCat(&(current->arg1->vals.str), &(current->arg2->vals.str)));
-                  current->arg1->NID = NID_STRING;
+            else if (ARG1->NID == NID_STRING) {
+               FLATTEN(ARG1);
+               if (ARG2->NID == NID_STRING) {
+                  FLATTEN(ARG2);
+                  CALL_CHECK(T_StringCat(&(ARG1->vals.str), &(ARG2->vals.str)));
+                  ARG1->NID = NID_STRING;
                }
                else {
                   T_String hstring;
-                  PTR_CHECK( (hstring.data = malloc(sizeof(char)*TSTRING_SIZE)));
+                  CALL_CHECK( T_StringInit(&hstring));
                   // pri chybe nastavi errno
-                  CALL_CHECK( T_StringFill(&hstring, *(current->arg2)));
-                  CALL_CHECK( T_StringCat(&(current->arg1->vals.str), &hstring));
-                  current->arg1->NID = NID_STRING;
-                  //free(hstring.data);
+                  int rc = T_StringFill(&hstring, *(ARG2));
+                  if (rc == EXIT_SUCCESS)
+                     rc = T_StringCat(&(ARG1->vals.str), &hstring);
+                  T_StringDelete(&hstring);
+                  CALL_CHECK(rc);
+                  ARG1->NID = NID_STRING;
                }
             }
             // Semanticka chyba
@@ -141,39 +405,37 @@ int Interpret(T_List *list, T_LabelList *lbl_list)
             }
          }
          else {
-            if (current->arg2->NID == NID_UNDEF || current->arg3->NID == NID_UNDEF) {
+            if (ARG2->NID == NID_UNDEF || ARG3->NID == NID_UNDEF) {
             errno = UNDEFINED_VARIABLE;
             return EXIT_FAILURE;
            }
             // Zrusenie obsahu premennej kde sa bude zapisovat
-            T_VarDelete(current->arg1);
-            T_VarInit(current->arg1);
+            T_VarDelete(ARG1);
+            T_VarInit(ARG1);
 
             // Soucet cisel
-            if (current->arg2->NID == NID_NUMBER && current->arg3->NID == NID_NUMBER) {
-               current->arg1->vals.d_val = current->arg2->vals.d_val + current->arg3->vals.d_val;
-               current->arg1->NID = NID_NUMBER;
+            if (ARG2->NID == NID_NUMBER && ARG3->NID == NID_NUMBER) {
+               CDoubleToT_Var(NUM_VAL(ARG2) + NUM_VAL(ARG3), ARG1);
+               QUICKEN((IS_INT(ARG2) && IS_INT(ARG3)) ? IID_PLUS_INT : IID_PLUS_NUM);
             }
             // Konkatenacia retazca
-            else if (current->arg2->NID == NID_STRING) {
-               current->arg1->vals.str.data = malloc(sizeof(char)*TSTRING_SIZE);
-
-               if (current->arg3->NID == NID_STRING) {
-                  // Konkatenacia T_String - vysledok do arg2
-                  // Prekopirovanie do premennej vysledku
-                  T_StringCopy(&(current->arg1->vals.str), &(current->arg2->vals.str));
-                  CALL_CHECK(T_StringCat(&(current->arg1->vals.str), &(current->arg3->vals.str)));
-                  current->arg1->NID = NID_STRING;
+            else if (ARG2->NID == NID_STRING) {
+               if (ARG3->NID == NID_STRING) {
+                  // Konkatenacia T_String - dlhy vysledok je rope bez kopirovania
+                  CALL_CHECK(T_VarConcat(ARG1, ARG2, ARG3));
+                  QUICKEN(IID_PLUS_STR);
                }
                else {
-                  T_String hstring;
-                  PTR_CHECK( (hstring.data = malloc(sizeof(char)*TSTRING_SIZE)));
+                  T_Var hvar;
+                  T_VarInit(&hvar);
+                  CALL_CHECK( T_StringInit(&(hvar.vals.str)));
+                  hvar.NID = NID_STRING;
                   // pri chybe nastavi errno vo funkcii
-                  CALL_CHECK( T_StringFill(&hstring, *(current->arg3)));
-                  CALL_CHECK( T_VarCopy(current->arg1, current->arg2));
-                  CALL_CHECK( T_StringCat(&(current->arg1->vals.str), &hstring));
-                  current->arg1->NID = NID_STRING;
-                  //free(hstring.data);
+                  int rc = T_StringFill(&(hvar.vals.str), *(ARG3));
+                  if (rc == EXIT_SUCCESS)
+                     rc = T_VarConcat(ARG1, ARG2, &hvar);
+                  T_VarDelete(&hvar);
+                  CALL_CHECK(rc);
                }
             }
             // Semanticka chyba
@@ -182,19 +444,19 @@ int Interpret(T_List *list, T_LabelList *lbl_list)
                return EXIT_FAILURE;
             }
          }
-         break;
+         NEXT;
 
       // - (minus) ----------------------------------------------------------------------------------------------------
-      case IID_DIFF:
+      CASE(IID_DIFF):
          DEBUG_INTERPRET_DIFF(current);
-         if (current->arg3 == NULL) {
-            if (current->arg1->NID == NID_UNDEF || current->arg2->NID == NID_UNDEF) {
+         if (current->arg3 == NO_SLOT) {
+            if (ARG1->NID == NID_UNDEF || ARG2->NID == NID_UNDEF) {
                errno = UNDEFINED_VARIABLE;
                return EXIT_FAILURE;
             }
             // Rozdiel len cisel
-            if (current->arg1->NID == NID_NUMBER && current->arg2->NID == NID_NUMBER) {
-               current->arg1->vals.d_val -= current->arg2->vals.d_val;
+            if (ARG1->NID == NID_NUMBER && ARG2->NID == NID_NUMBER) {
+               CDoubleToT_Var(NUM_VAL(ARG1) - NUM_VAL(ARG2), ARG1);
             }
             // Semanticka chyba
             else {
@@ -203,17 +465,17 @@ int Interpret(T_List *list, T_LabelList *lbl_list)
             }
          }
          else {
-            if (current->arg2->NID == NID_UNDEF || current->arg3->NID == NID_UNDEF) {
+            if (ARG2->NID == NID_UNDEF || ARG3->NID == NID_UNDEF) {
                errno = UNDEFINED_VARIABLE;
                return EXIT_FAILURE;
             }
             // Rozdiel len cisel
-            if (current->arg2->NID == NID_NUMBER && current->arg3->NID == NID_NUMBER) {
+            if (ARG2->NID == NID_NUMBER && ARG3->NID == NID_NUMBER) {
                // Zrusenie obsahu premennej kde sa bude zapisovat
-               T_VarDelete(current->arg1);
-               T_VarInit(current->arg1);
-               current->arg1->NID = NID_NUMBER;
-               current->arg1->vals.d_val = current->arg2->vals.d_val - current->arg3->vals.d_val;
+               T_VarDelete(ARG1);
+               T_VarInit(ARG1);
+               CDoubleToT_Var(NUM_VAL(ARG2) - NUM_VAL(ARG3), ARG1);
+               QUICKEN((IS_INT(ARG2) && IS_INT(ARG3)) ? IID_DIFF_INT : IID_DIFF_NUM);
             }
             // Semanticka chyba
             else {
@@ -221,48 +483,49 @@ int Interpret(T_List *list, T_LabelList *lbl_list)
                return EXIT_FAILURE;
             }
          }
-         break;
+         NEXT;
 
       // * (krat) ---------------------------------------------------------------------------------------------------
-      case IID_MUL:
+      CASE(IID_MUL):
          DEBUG_INTERPRET_MUL(current);
-         if (current->arg3 == NULL) {
-            if (current->arg1->NID == NID_UNDEF || current->arg2->NID == NID_UNDEF) {
+         if (current->arg3 == NO_SLOT) {
+            if (ARG1->NID == NID_UNDEF || ARG2->NID == NID_UNDEF) {
                errno = UNDEFINED_VARIABLE;
                return EXIT_FAILURE;
             }
             // Nasobeni cisel
-            if (current->arg1->NID == NID_NUMBER && current->arg2->NID == NID_NUMBER) {
-               current->arg1->vals.d_val *= current->arg2->vals.d_val;
+            if (ARG1->NID == NID_NUMBER && ARG2->NID == NID_NUMBER) {
+               CDoubleToT_Var(NUM_VAL(ARG1) * NUM_VAL(ARG2), ARG1);
             }
             // Mocnina retazca
-            else if (current->arg1->NID == NID_STRING && current->arg2->NID == NID_NUMBER) {
+            else if (ARG1->NID == NID_STRING && ARG2->NID == NID_NUMBER) {
+               FLATTEN(ARG1);
                // pomocna premenna, kolkokrat sa umocnit
-               int mocn = (int)current->arg2->vals.d_val;
+               int mocn = (int)INT_VAL(ARG2);
 
                // Vrati prazdny retazec
                if ( mocn == 0 ) {
-                  if (current->arg1->vals.str.length > 0) {
-                     char *hptr;
-                     PTR_CHECK( (hptr = realloc(current->arg1->vals.str.data, sizeof(char)*TSTRING_SIZE)));
-                     current->arg1->vals.str.data = hptr;
+                  if (STRING_LENGTH(&ARG1->vals.str) > 0) {
+                     T_StringDelete(&(ARG1->vals.str));
+                     CALL_CHECK(T_StringInit(&(ARG1->vals.str)));
                   }
-
-                  current->arg1->vals.str.data[0] = '\0';
-                  current->arg1->vals.str.length = 0;
                }
                // Umocnovani
                else if ( mocn > 0 ) {
                   T_Var pom;
                   T_VarInit(&pom);
-                  T_VarCopy(&pom, current->arg1);
+                  CALL_CHECK(T_VarCopy(&pom, ARG1));
 
                   // Vykona sa (mocn-1)-nasobna konkatenacia
                   mocn -= 1;
 
                   for ( ; mocn > 0; mocn--)
-                     T_StringCat(&(current->arg1->vals.str), &(pom.vals.str));
-                  current->arg1->NID = NID_STRING;
+                     if (T_StringCat(&(ARG1->vals.str), &(pom.vals.str)) == EXIT_FAILURE) {
+                        T_VarDelete(&pom);
+                        return EXIT_FAILURE;
+                     }
+                  T_VarDelete(&pom);
+                  ARG1->NID = NID_STRING;
                }
                // Semanticka chyba
                else {
@@ -276,23 +539,23 @@ int Interpret(T_List *list, T_LabelList *lbl_list)
             }
          }
          else {
-            if (current->arg2->NID == NID_UNDEF || current->arg3->NID == NID_UNDEF) {
+            if (ARG2->NID == NID_UNDEF || ARG3->NID == NID_UNDEF) {
                errno = UNDEFINED_VARIABLE;
                return EXIT_FAILURE;
             }
             // Zrusenie obsahu premennej kde sa bude zapisovat
-            T_VarDelete(current->arg1);
-            T_VarInit(current->arg1);
+            T_VarDelete(ARG1);
+            T_VarInit(ARG1);
 
             // Nasobenie cisel
-            if (current->arg2->NID == NID_NUMBER && current->arg3->NID == NID_NUMBER) {
-               current->arg1->NID = NID_NUMBER;
-               current->arg1->vals.d_val = current->arg2->vals.d_val * current->arg3->vals.d_val;
+            if (ARG2->NID == NID_NUMBER && ARG3->NID == NID_NUMBER) {
+               CDoubleToT_Var(NUM_VAL(ARG2) * NUM_VAL(ARG3), ARG1);
+               QUICKEN((IS_INT(ARG2) && IS_INT(ARG3)) ? IID_MUL_INT : IID_MUL_NUM);
             }
             // Mocnina retazca
-            else if (current->arg2->NID == NID_STRING && current->arg3->NID == NID_NUMBER) {
-
-               int mocn = (int)current->arg3->vals.d_val;
+            else if (ARG2->NID == NID_STRING && ARG3->NID == NID_NUMBER) {
+               FLATTEN(ARG2);
+               int mocn = (int)INT_VAL(ARG3);
 
                // Semanticka chyba
                if ( mocn < 0 ) {
@@ -301,19 +564,17 @@ int Interpret(T_List *list, T_LabelList *lbl_list)
                }
 
                // Alokacia polozky do ktorej sa bude zapisovat
-               PTR_CHECK( (current->arg1->vals.str.data = malloc(sizeof(char)*TSTRING_SIZE)));
+               CALL_CHECK(T_StringInit(&(ARG1->vals.str)));
 
                // Vrati prazdny retazec
                if ( mocn == 0 ) {
-                  current->arg1->NID = NID_STRING;
-                  current->arg1->vals.str.data[0] = '\0';
-                  current->arg1->vals.str.length = 0;
+                  ARG1->NID = NID_STRING;
                }
                // Vykona mocn-nasobnu konkatenaciu
                else {
+                  ARG1->NID = NID_STRING;
                   for ( ; mocn > 0; mocn--)
-                     T_StringCat(&(current->arg1->vals.str), &(current->arg2->vals.str));
-                  current->arg1->NID = NID_STRING;
+                     CALL_CHECK(T_StringCat(&(ARG1->vals.str), &(ARG2->vals.str)));
                }
             }
             // Semanticka chyba
@@ -322,23 +583,23 @@ int Interpret(T_List *list, T_LabelList *lbl_list)
                return EXIT_FAILURE;
             }
          }
-         break;
+         NEXT;
 
       // / (deleno) ------------------------------------------------------------------------------------
-      case IID_DIV:
+      CASE(IID_DIV):
          DEBUG_INTERPRET_DIV(current);
          // Deleni len cisel
-         if (current->arg3 == NULL) {
-            if (current->arg1->NID == NID_UNDEF || current->arg2->NID == NID_UNDEF) {
+         if (current->arg3 == NO_SLOT) {
+            if (ARG1->NID == NID_UNDEF || ARG2->NID == NID_UNDEF) {
                errno = UNDEFINED_VARIABLE;
                return EXIT_FAILURE;
             }
-            if (current->arg1->NID == NID_NUMBER && current->arg2->NID == NID_NUMBER) {
-               if (current->arg2->vals.d_val == 0) {
+            if (ARG1->NID == NID_NUMBER && ARG2->NID == NID_NUMBER) {
+               if (NUM_VAL(ARG2) == 0) {
                   errno = DIVIDE_ZERO;
                   return EXIT_FAILURE;
                }
-               current->arg1->vals.d_val /= current->arg2->vals.d_val;
+               CDoubleToT_Var(NUM_VAL(ARG1) / NUM_VAL(ARG2), ARG1);
             }
             else {
                errno = TYPE_COMPATIBILITY_ERROR;
@@ -346,38 +607,38 @@ int Interpret(T_List *list, T_LabelList *lbl_list)
             }
          }
          else {
-            if (current->arg2->NID == NID_UNDEF || current->arg3->NID == NID_UNDEF) {
+            if (ARG2->NID == NID_UNDEF || ARG3->NID == NID_UNDEF) {
                errno = UNDEFINED_VARIABLE;
                return EXIT_FAILURE;
             }
-            if (current->arg2->NID == NID_NUMBER && current->arg3->NID == NID_NUMBER) {
-               if (current->arg3->vals.d_val == 0) {
+            if (ARG2->NID == NID_NUMBER && ARG3->NID == NID_NUMBER) {
+               if (NUM_VAL(ARG3) == 0) {
                   errno = DIVIDE_ZERO;
                   return EXIT_FAILURE;
                }
-               T_VarDelete(current->arg1);
-               T_VarInit(current->arg1);
-               current->arg1->NID = NID_NUMBER;
-               current->arg1->vals.d_val = current->arg2->vals.d_val / current->arg3->vals.d_val;
+               T_VarDelete(ARG1);
+               T_VarInit(ARG1);
+               CDoubleToT_Var(NUM_VAL(ARG2) / NUM_VAL(ARG3), ARG1);
+               QUICKEN((IS_INT(ARG2) && IS_INT(ARG3)) ? IID_DIV_INT : IID_DIV_NUM);
             }
             else {
                errno = TYPE_COMPATIBILITY_ERROR;
                return EXIT_FAILURE;
             }
          }
-         break;
+         NEXT;
 
       // ** (umocnovanie) ----------------------------------------------------------------------------------
-      case IID_PWR:
+      CASE(IID_PWR):
          DEBUG_INTERPRET_PWR(current);
          // Mocnina len cisel
-         if (current->arg3 == NULL) {
-            if (current->arg1->NID == NID_UNDEF || current->arg2->NID == NID_UNDEF) {
+         if (current->arg3 == NO_SLOT) {
+            if (ARG1->NID == NID_UNDEF || ARG2->NID == NID_UNDEF) {
                errno = UNDEFINED_VARIABLE;
                return EXIT_FAILURE;
             }
-            if (current->arg1->NID == NID_NUMBER && current->arg2->NID == NID_NUMBER) {
-               current->arg1->vals.d_val = pow(current->arg1->vals.d_val, current->arg2->vals.d_val);
+            if (ARG1->NID == NID_NUMBER && ARG2->NID == NID_NUMBER) {
+               CDoubleToT_Var(pow(NUM_VAL(ARG1), NUM_VAL(ARG2)), ARG1);
             }
             else {
                errno = TYPE_COMPATIBILITY_ERROR;
@@ -385,305 +646,702 @@ int Interpret(T_List *list, T_LabelList *lbl_list)
             }
          }
          else {
-            if (current->arg2->NID == NID_UNDEF || current->arg3->NID == NID_UNDEF) {
+            if (ARG2->NID == NID_UNDEF || ARG3->NID == NID_UNDEF) {
                errno = UNDEFINED_VARIABLE;
                return EXIT_FAILURE;
             }
-            if (current->arg2->NID == NID_NUMBER && current->arg3->NID == NID_NUMBER) {
-               T_VarDelete(current->arg1);
-               T_VarInit(current->arg1);
-               current->arg1->NID = NID_NUMBER;
-               current->arg1->vals.d_val = pow(current->arg2->vals.d_val, current->arg3->vals.d_val);
+            if (ARG2->NID == NID_NUMBER && ARG3->NID == NID_NUMBER) {
+               T_VarDelete(ARG1);
+               T_VarInit(ARG1);
+               CDoubleToT_Var(pow(NUM_VAL(ARG2), NUM_VAL(ARG3)), ARG1);
+               QUICKEN(IID_PWR_NUM);
             }
             else {
                errno = TYPE_COMPATIBILITY_ERROR;
                return EXIT_FAILURE;
             }
          }
-         break;
+         NEXT;
 
       // cut string[index:index] --------------------------------------------------------------------------
-      case IID_CUT:
+      CASE(IID_CUT):
          DEBUG_INTERPRET_CUT(current);
          // Vybranie podretazca z retazca
-         if (current->arg1->NID == NID_UNDEF || current->arg2->NID == NID_UNDEF || current->arg3->NID == NID_UNDEF) {
+         if (ARG1->NID == NID_UNDEF
+             || (current->arg2 != NO_SLOT && ARG2->NID == NID_UNDEF)
+             || (current->arg3 != NO_SLOT && ARG3->NID == NID_UNDEF)) {
             errno = UNDEFINED_VARIABLE;
             return EXIT_FAILURE;
          }
 
-         if (current->arg1->NID == NID_STRING) {
+         if (ARG1->NID == NID_STRING) {
+            // Zdroj moze byt zdielany alebo rope, precita sa bez spajania
             T_String hstr;
-            T_StringInit(&hstr);
-
-            if ((current->arg2 == NULL) &&(current->arg3->NID==NID_NUMBER))
-               CutString(&hstr , &(current->arg1->vals.str), 0, current->arg3->vals.d_val);
-            else if ((current->arg3 == NULL)&& (current->arg2->NID==NID_NUMBER))
-               CutString(&hstr, &(current->arg1->vals.str), current->arg2->vals.d_val, current->arg1->vals.str.length);
-            else if ((current->arg3->NID==NID_NUMBER)&& (current->arg2->NID==NID_NUMBER))
-               CutString(&hstr, &(current->arg1->vals.str), current->arg2->vals.d_val, current->arg3->vals.d_val);
-	    else {
+            CALL_CHECK(T_StringInit(&hstr));
+
+            int rc;
+            if ((current->arg2 == NO_SLOT) &&(ARG3->NID==NID_NUMBER))
+               rc = T_VarCut(&hstr, ARG1, 0, INT_VAL(ARG3));
+            else if ((current->arg3 == NO_SLOT)&& (ARG2->NID==NID_NUMBER))
+               rc = T_VarCut(&hstr, ARG1, INT_VAL(ARG2), VAR_LENGTH(ARG1));
+            else if ((ARG3->NID==NID_NUMBER)&& (ARG2->NID==NID_NUMBER))
+               rc = T_VarCut(&hstr, ARG1, INT_VAL(ARG2), INT_VAL(ARG3));
+            else {
                errno = TYPE_COMPATIBILITY_ERROR;
+               rc = EXIT_FAILURE;
+            }
+            if (rc == EXIT_FAILURE) {
+               T_StringDelete(&hstr);
                return EXIT_FAILURE;
             }
 
             // Zrusenie obsahu premennej kde sa bude zapisovat
-            T_VarDelete(current->arg1);
-            T_VarInit(current->arg1);
+            T_VarDelete(ARG1);
+            T_VarInit(ARG1);
 
             // Naplne vyslednej premennej
-            current->arg1->NID = NID_STRING;
-            current->arg1->vals.str.length = strlen(hstr.data);
-            current->arg1->vals.str = hstr;
+            ARG1->NID = NID_STRING;
+            ARG1->vals.str = hstr;
          }
          // Semanticka chyba
          else {
                errno = TYPE_COMPATIBILITY_ERROR;
                return EXIT_FAILURE;
                }
-         break;
+         NEXT;
 
       /* False 0
          True 1
       */
       // == relacny operator - porovnanie -----------------------------------------------------------------------------
-      case IID_EQUAL:
-         if (current->arg1->NID == NID_UNDEF || current->arg2->NID == NID_UNDEF || current->arg3->NID == NID_UNDEF) {
+      CASE(IID_EQUAL):
+         if (ARG1->NID == NID_UNDEF || ARG2->NID == NID_UNDEF || ARG3->NID == NID_UNDEF) {
             errno = UNDEFINED_VARIABLE;
             return EXIT_FAILURE;
          }
 
          // musia sa rovnat typy aj hodnoty
-         T_VarDelete(current->arg1);
-         T_VarInit(current->arg1);
-         current->arg1->NID = NID_BOOL;
+         T_VarDelete(ARG1);
+         T_VarInit(ARG1);
+         ARG1->NID = NID_BOOL;
 
-         if ((current->arg2->NID != NID_CONST && current->arg2->NID != NID_UNDEF && current->arg2->NID != NID_FUNCTION)
-            && (current->arg3->NID != NID_CONST && current->arg3->NID != NID_UNDEF && current->arg3->NID != NID_FUNCTION))
+         if ((ARG2->NID != NID_CONST && ARG2->NID != NID_UNDEF && ARG2->NID != NID_FUNCTION)
+            && (ARG3->NID != NID_CONST && ARG3->NID != NID_UNDEF && ARG3->NID != NID_FUNCTION))
             {
-            current->arg1->vals.b_val = RelType((*current->arg2), (*current->arg3));
+            FLATTEN(ARG2);
+            FLATTEN(ARG3);
+            ARG1->vals.b_val = RelType((*ARG2), (*ARG3));
          }
          // Semanticka chyba
          else {
             errno = TYPE_COMPATIBILITY_ERROR;
             return EXIT_FAILURE;
          }
-         break;
+         NEXT;
 
       // != relacny operator - nerovnost --------------------------------------------------------------------------------
-      case IID_UNEQUAL:
-         if (current->arg1->NID == NID_UNDEF || current->arg2->NID == NID_UNDEF || current->arg3->NID == NID_UNDEF) {
+      CASE(IID_UNEQUAL):
+         if (ARG1->NID == NID_UNDEF || ARG2->NID == NID_UNDEF || ARG3->NID == NID_UNDEF) {
             errno = UNDEFINED_VARIABLE;
             return EXIT_FAILURE;
          }
 
          // nesmu sa rovnat typy alebo hodnoty - negacia rovnosti
-         T_VarDelete(current->arg1);
-         T_VarInit(current->arg1);
-         current->arg1->NID = NID_BOOL;
+         T_VarDelete(ARG1);
+         T_VarInit(ARG1);
+         ARG1->NID = NID_BOOL;
 
-         if ((current->arg2->NID != NID_CONST && current->arg2->NID != NID_UNDEF && current->arg2->NID != NID_FUNCTION)
-            && (current->arg3->NID != NID_CONST && current->arg3->NID != NID_UNDEF && current->arg3->NID != NID_FUNCTION))
+         if ((ARG2->NID != NID_CONST && ARG2->NID != NID_UNDEF && ARG2->NID != NID_FUNCTION)
+            && (ARG3->NID != NID_CONST && ARG3->NID != NID_UNDEF && ARG3->NID != NID_FUNCTION))
             {
-            int retval = RelType((*current->arg2), (*current->arg3));
-            current->arg1->vals.b_val = ((retval == 0) ? 1 : 0 );
+            FLATTEN(ARG2);
+            FLATTEN(ARG3);
+            int retval = RelType((*ARG2), (*ARG3));
+            ARG1->vals.b_val = ((retval == 0) ? 1 : 0 );
          }
          // Semanticka chyba
          else {
             errno = UNDEFINED_VARIABLE;
             return EXIT_FAILURE;
          }
-         break;
+         NEXT;
 
       // >= relacny operator --------------------------------------------------------------------------------------------------
-      case IID_BEQUAL:
-         if (current->arg1->NID == NID_UNDEF || current->arg2->NID == NID_UNDEF || current->arg3->NID == NID_UNDEF) {
+      CASE(IID_BEQUAL):
+         if (ARG1->NID == NID_UNDEF || ARG2->NID == NID_UNDEF || ARG3->NID == NID_UNDEF) {
             errno = UNDEFINED_VARIABLE;
             return EXIT_FAILURE;
          }
          // len NID_NUMBER alebo NID_STRING
-         T_VarDelete(current->arg1);
-         T_VarInit(current->arg1);
-         current->arg1->NID = NID_BOOL;
+         T_VarDelete(ARG1);
+         T_VarInit(ARG1);
+         ARG1->NID = NID_BOOL;
 
-         if ((current->arg2->NID == current->arg3->NID) && current->arg2->NID == NID_NUMBER) {
-            current->arg1->vals.b_val = ((current->arg2->vals.d_val >= current->arg3->vals.d_val) ? 1 : 0);
+         if ((ARG2->NID == ARG3->NID) && ARG2->NID == NID_NUMBER) {
+            ARG1->vals.b_val = ((NUM_VAL(ARG2) >= NUM_VAL(ARG3)) ? 1 : 0);
          }
-         else if ( (current->arg2->NID == current->arg3->NID) && current->arg2->NID == NID_STRING) {
-            int retval = strcmp(current->arg2->vals.str.data, current->arg3->vals.str.data);
-            current->arg1->vals.b_val = (( retval >= 0 ) ? 1 : 0);
+         else if ( (ARG2->NID == ARG3->NID) && ARG2->NID == NID_STRING) {
+            FLATTEN(ARG2);
+            FLATTEN(ARG3);
+            int retval = strcmp(ARG2->vals.str.data, ARG3->vals.str.data);
+            ARG1->vals.b_val = (( retval >= 0 ) ? 1 : 0);
          }
          // Semanticka chyba
          else {
             errno = TYPE_COMPATIBILITY_ERROR;
             return EXIT_FAILURE;
          }
-         break;
+         NEXT;
 
       // <= relacny operator --------------------------------------------------------------------------------------------------
-      case IID_SMEQUAL:
-         if (current->arg1->NID == NID_UNDEF || current->arg2->NID == NID_UNDEF || current->arg3->NID == NID_UNDEF) {
+      CASE(IID_SMEQUAL):
+         if (ARG1->NID == NID_UNDEF || ARG2->NID == NID_UNDEF || ARG3->NID == NID_UNDEF) {
             errno = UNDEFINED_VARIABLE;
             return EXIT_FAILURE;
          }
          // len NID_NUMBER alebo NID_STRING
-         T_VarDelete(current->arg1);
-         T_VarInit(current->arg1);
-         current->arg1->NID = NID_BOOL;
+         T_VarDelete(ARG1);
+         T_VarInit(ARG1);
+         ARG1->NID = NID_BOOL;
 
-         if ((current->arg2->NID == current->arg3->NID) && current->arg2->NID == NID_NUMBER) {
-            current->arg1->vals.b_val = ((current->arg2->vals.d_val <= current->arg3->vals.d_val) ? 1 : 0);
+         if ((ARG2->NID == ARG3->NID) && ARG2->NID == NID_NUMBER) {
+            ARG1->vals.b_val = ((NUM_VAL(ARG2) <= NUM_VAL(ARG3)) ? 1 : 0);
          }
-         else if ( (current->arg2->NID == current->arg3->NID) && current->arg2->NID == NID_STRING) {
-            int retval = strcmp(current->arg2->vals.str.data, current->arg3->vals.str.data);
-            current->arg1->vals.b_val = (( retval <= 0 ) ? 1 : 0);
+         else if ( (ARG2->NID == ARG3->NID) && ARG2->NID == NID_STRING) {
+            FLATTEN(ARG2);
+            FLATTEN(ARG3);
+            int retval = strcmp(ARG2->vals.str.data, ARG3->vals.str.data);
+            ARG1->vals.b_val = (( retval <= 0 ) ? 1 : 0);
          }
          // Semanticka chyba
          else {
             errno = TYPE_COMPATIBILITY_ERROR;
             return EXIT_FAILURE;
          }
-         break;
+         NEXT;
 
       // < relacny operator --------------------------------------------------------------------------------------------------
-      case IID_SMALLER:
-         if (current->arg1->NID == NID_UNDEF || current->arg2->NID == NID_UNDEF || current->arg3->NID == NID_UNDEF) {
+      CASE(IID_SMALLER):
+         if (ARG1->NID == NID_UNDEF || ARG2->NID == NID_UNDEF || ARG3->NID == NID_UNDEF) {
             errno = UNDEFINED_VARIABLE;
             return EXIT_FAILURE;
          }
          // len NID_NUMBER alebo NID_STRING
-         T_VarDelete(current->arg1);
-         T_VarInit(current->arg1);
-         current->arg1->NID = NID_BOOL;
+         T_VarDelete(ARG1);
+         T_VarInit(ARG1);
+         ARG1->NID = NID_BOOL;
 
-         if ((current->arg2->NID == current->arg3->NID) && current->arg2->NID == NID_NUMBER) {
-            current->arg1->vals.b_val = ((current->arg2->vals.d_val < current->arg3->vals.d_val) ? 1 : 0);
+         if ((ARG2->NID == ARG3->NID) && ARG2->NID == NID_NUMBER) {
+            ARG1->vals.b_val = ((NUM_VAL(ARG2) < NUM_VAL(ARG3)) ? 1 : 0);
          }
-         else if ( (current->arg2->NID == current->arg3->NID) && current->arg2->NID == NID_STRING) {
-            int retval = strcmp(current->arg2->vals.str.data, current->arg3->vals.str.data);
-            current->arg1->vals.b_val = (( retval < 0 ) ? 1 : 0);
+         else if ( (ARG2->NID == ARG3->NID) && ARG2->NID == NID_STRING) {
+            FLATTEN(ARG2);
+            FLATTEN(ARG3);
+            int retval = strcmp(ARG2->vals.str.data, ARG3->vals.str.data);
+            ARG1->vals.b_val = (( retval < 0 ) ? 1 : 0);
          }
          // Semanticka chyba
          else {
             errno = TYPE_COMPATIBILITY_ERROR;
             return EXIT_FAILURE;
          }
-         break;
+         NEXT;
 
       // > relacny operator --------------------------------------------------------------------------------------------------
-      case IID_BIGGER:
-         if (current->arg1->NID == NID_UNDEF || current->arg2->NID == NID_UNDEF || current->arg3->NID == NID_UNDEF) {
+      CASE(IID_BIGGER):
+         if (ARG1->NID == NID_UNDEF || ARG2->NID == NID_UNDEF || ARG3->NID == NID_UNDEF) {
             errno = UNDEFINED_VARIABLE;
             return EXIT_FAILURE;
          }
          // len NID_NUMBER alebo NID_STRING
-         T_VarDelete(current->arg1);
-         T_VarInit(current->arg1);
-         current->arg1->NID = NID_BOOL;
+         T_VarDelete(ARG1);
+         T_VarInit(ARG1);
+         ARG1->NID = NID_BOOL;
 
-         if ((current->arg2->NID == current->arg3->NID) && current->arg2->NID == NID_NUMBER) {
-            current->arg1->vals.b_val = ((current->arg2->vals.d_val > current->arg3->vals.d_val) ? 1 : 0);
+         if ((ARG2->NID == ARG3->NID) && ARG2->NID == NID_NUMBER) {
+            ARG1->vals.b_val = ((NUM_VAL(ARG2) > NUM_VAL(ARG3)) ? 1 : 0);
          }
-         else if ( (current->arg2->NID == current->arg3->NID) && current->arg2->NID == NID_STRING) {
-            int retval = strcmp(current->arg2->vals.str.data, current->arg3->vals.str.data);
-            current->arg1->vals.b_val = (( retval > 0 ) ? 1 : 0);
+         else if ( (ARG2->NID == ARG3->NID) && ARG2->NID == NID_STRING) {
+            FLATTEN(ARG2);
+            FLATTEN(ARG3);
+            int retval = strcmp(ARG2->vals.str.data, ARG3->vals.str.data);
+            ARG1->vals.b_val = (( retval > 0 ) ? 1 : 0);
          }
          // Semanticka chyba
          else {
             errno = TYPE_COMPATIBILITY_ERROR;
             return EXIT_FAILURE;
          }
-         break;
+         NEXT;
 
       // Volani vnitrnich funkci z builtinu
-      case IID_INPUT:
-            CALL_CHECK( Input(current->arg1));
-            current->arg1->NID = NID_STRING;
-      break;
+      CASE(IID_INPUT):
+            CALL_CHECK( Input(ctx, ARG1));
+            ARG1->NID = NID_STRING;
+      NEXT;
 
-      case IID_NUMERIC:
+      CASE(IID_NUMERIC):
          // viz builtin
-         CALL_CHECK(Numeric(current->arg1, current->arg2));
-      break;
+         CALL_CHECK(Numeric(ARG1, ARG2));
+      NEXT;
 
-      case IID_PRINT:
-         CALL_CHECK(Print(current->arg1, current->arg2));
-      break;
+      CASE(IID_PRINT):
+         CALL_CHECK(Print(ctx, ARG1, ARG2));
+      NEXT;
 
-      case IID_TYPEOF:
-         CALL_CHECK(TypeOf(current->arg1, current->arg2));
-      break;
+      CASE(IID_TYPEOF):
+         CALL_CHECK(TypeOf(ARG1, ARG2));
+      NEXT;
 
-      case IID_LEN:
-         CALL_CHECK(Len(current->arg1, current->arg2));
-      break;
+      CASE(IID_LEN):
+         CALL_CHECK(Len(ARG1, ARG2));
+      NEXT;
 
-      case IID_FIND:
-         if ((current->arg2->NID == NID_UNDEF) || (current->arg3->NID == NID_UNDEF)) {
+      CASE(IID_FIND):
+         if ((ARG2->NID == NID_UNDEF) || (ARG3->NID == NID_UNDEF)) {
             errno = UNDEFINED_VARIABLE;
             return EXIT_FAILURE;
          }
 
-         if ((current->arg2->NID == NID_STRING) && (current->arg3->NID == NID_STRING)) {
-            CALL_CHECK(Find(current->arg2, current->arg3, current->arg1)); // v arg2 najdi podretezec arg3, vrat pozici pomoci arg1
+         if ((ARG2->NID == NID_STRING) && (ARG3->NID == NID_STRING)) {
+            CALL_CHECK(Find(ARG2, ARG3, ARG1)); // v arg2 najdi podretezec arg3, vrat pozici pomoci arg1
          }
          else {
             errno = TYPE_COMPATIBILITY_ERROR;
             return EXIT_FAILURE;
          }
-      break;
+      NEXT;
 
-      case IID_SORT:
-         if (current->arg2->NID == NID_UNDEF) {
+      CASE(IID_SORT):
+         if (ARG2->NID == NID_UNDEF) {
             errno = UNDEFINED_VARIABLE;
             return EXIT_FAILURE;
          }
 
-         if (current->arg2->NID == NID_STRING) {
-            CALL_CHECK( Sort(current->arg2, current->arg1));
+         if (ARG2->NID == NID_STRING) {
+            CALL_CHECK( Sort(ARG2, ARG1));
          }
          else {
             errno = TYPE_COMPATIBILITY_ERROR;
             return EXIT_FAILURE;
          }
-      break;
+      NEXT;
+
+      /* Specializovane (quickened) instrukcie ---------------------------------------------------------------------
+         Vseobecna instrukcia sa po prvom vykonani prepise na variant pre typy
+         operandov, ktore prave videla. Variant overi len typy operandov; ak
+         nesedia, prepise sa naspat a instrukcia sa vykona vseobecne.
+      */
+      CASE(IID_PLUS_NUM):
+         if (ARG2->NID != NID_NUMBER || ARG3->NID != NID_NUMBER) {
+            current->IID = IID_PLUS;
+            REDISPATCH;
+         }
+         NUM_RESULT(ARG1, NUM_VAL(ARG2) + NUM_VAL(ARG3));
+         NEXT;
 
+      // x = x + e bez docasnej premennej, retazec x sa predlzi vo svojom buffri
+      CASE(IID_APPEND):
+         if (ARG1->NID == NID_UNDEF || ARG2->NID == NID_UNDEF) {
+            errno = UNDEFINED_VARIABLE;
+            return EXIT_FAILURE;
+         }
+         if (ARG1->NID == NID_STRING) {
+            // cielovy rope sa spoji raz, dalej sa pripaja do plocheho buffra
+            FLATTEN(ARG1);
+            if (ARG2->NID == NID_STRING) {
+               FLATTEN(ARG2);
+               CALL_CHECK(T_StringCat(&(ARG1->vals.str), &(ARG2->vals.str)));
+            }
+            else {
+               T_String hstring;
+               CALL_CHECK(T_StringInit(&hstring));
+               int rc = T_StringFill(&hstring, *(ARG2));
+               if (rc == EXIT_SUCCESS)
+                  rc = T_StringCat(&(ARG1->vals.str), &hstring);
+               T_StringDelete(&hstring);
+               CALL_CHECK(rc);
+            }
+         }
+         else if (IS_INT(ARG1) && IS_INT(ARG2)) {
+            int64_t r = ARG1->vals.i_val + ARG2->vals.i_val;
+            if (IN_INT_RANGE(r)) {
+               INT_RESULT(ARG1, r);
+            }
+            else {
+               NUM_RESULT(ARG1, (double)r);
+            }
+         }
+         else if (ARG1->NID == NID_NUMBER && ARG2->NID == NID_NUMBER) {
+            NUM_RESULT(ARG1, NUM_VAL(ARG1) + NUM_VAL(ARG2));
+         }
+         else {
+            errno = TYPE_COMPATIBILITY_ERROR;
+            return EXIT_FAILURE;
+         }
+         NEXT;
+
+      CASE(IID_PLUS_STR):
+         if (ARG2->NID != NID_STRING || ARG3->NID != NID_STRING) {
+            current->IID = IID_PLUS;
+            REDISPATCH;
+         }
+         CALL_CHECK(T_VarConcat(ARG1, ARG2, ARG3));
+         NEXT;
+
+      CASE(IID_DIFF_NUM):
+         if (ARG2->NID != NID_NUMBER || ARG3->NID != NID_NUMBER) {
+            current->IID = IID_DIFF;
+            REDISPATCH;
+         }
+         NUM_RESULT(ARG1, NUM_VAL(ARG2) - NUM_VAL(ARG3));
+         NEXT;
+
+      CASE(IID_MUL_NUM):
+         if (ARG2->NID != NID_NUMBER || ARG3->NID != NID_NUMBER) {
+            current->IID = IID_MUL;
+            REDISPATCH;
+         }
+         NUM_RESULT(ARG1, NUM_VAL(ARG2) * NUM_VAL(ARG3));
+         NEXT;
+
+      CASE(IID_DIV_NUM):
+         if (ARG2->NID != NID_NUMBER || ARG3->NID != NID_NUMBER
+             || NUM_VAL(ARG3) == 0) {
+            current->IID = IID_DIV;
+            REDISPATCH;
+         }
+         NUM_RESULT(ARG1, NUM_VAL(ARG2) / NUM_VAL(ARG3));
+         NEXT;
+
+      CASE(IID_PWR_NUM):
+         if (ARG2->NID != NID_NUMBER || ARG3->NID != NID_NUMBER) {
+            current->IID = IID_PWR;
+            REDISPATCH;
+         }
+         NUM_RESULT(ARG1, pow(NUM_VAL(ARG2), NUM_VAL(ARG3)));
+         NEXT;
+
+      /* Celociselne varianty, operandy maju SUB_INT. Vysledok mimo INT_LIMIT,
+         necely podiel a -0.0 (napr. 0 * -1) sa zapisu ako double, rovnako
+         ako vo vseobecnej instrukcii.
+      */
+      CASE(IID_PLUS_INT):
+         if (!IS_INT(ARG2) || !IS_INT(ARG3)) {
+            current->IID = IID_PLUS;
+            REDISPATCH;
+         }
+         {
+            int64_t r = ARG2->vals.i_val + ARG3->vals.i_val;
+            if (IN_INT_RANGE(r)) {
+               INT_RESULT(ARG1, r);
+            }
+            else {
+               NUM_RESULT(ARG1, (double)r);
+            }
+         }
+         NEXT;
+
+      CASE(IID_DIFF_INT):
+         if (!IS_INT(ARG2) || !IS_INT(ARG3)) {
+            current->IID = IID_DIFF;
+            REDISPATCH;
+         }
+         {
+            int64_t r = ARG2->vals.i_val - ARG3->vals.i_val;
+            if (IN_INT_RANGE(r)) {
+               INT_RESULT(ARG1, r);
+            }
+            else {
+               NUM_RESULT(ARG1, (double)r);
+            }
+         }
+         NEXT;
+
+      CASE(IID_MUL_INT):
+         if (!IS_INT(ARG2) || !IS_INT(ARG3)) {
+            current->IID = IID_MUL;
+            REDISPATCH;
+         }
+         {
+            int64_t a = ARG2->vals.i_val;
+            int64_t b = ARG3->vals.i_val;
+            double d = (double)a * (double)b;
+            if (d > -INT_LIMIT && d < INT_LIMIT && !(d == 0.0 && (a < 0 || b < 0))) {
+               INT_RESULT(ARG1, a * b);
+            }
+            else {
+               NUM_RESULT(ARG1, d);
+            }
+         }
+         NEXT;
+
+      CASE(IID_DIV_INT):
+         if (!IS_INT(ARG2) || !IS_INT(ARG3) || ARG3->vals.i_val == 0) {
+            current->IID = IID_DIV;
+            REDISPATCH;
+         }
+         {
+            int64_t a = ARG2->vals.i_val;
+            int64_t b = ARG3->vals.i_val;
+            if (a % b == 0 && !(a == 0 && b < 0)) {
+               INT_RESULT(ARG1, a / b);
+            }
+            else {
+               NUM_RESULT(ARG1, (double)a / (double)b);
+            }
+         }
+         NEXT;
+
+      /* Porovnanie spojene so skokom (viz Optimize()) ----------------------------------------------------------
+         IID: IID_BR_*; arg1 = index instrukcie za navestim, arg2 a arg3 = porovnavane operandy.
+         Skace, ak relacia neplati. Vseobecny variant sa prepise na variant pre cele cisla alebo cisla,
+         pri == a != aj pre retazce.
+      */
+      CASE(IID_BR_EQUAL):
+      CASE(IID_BR_UNEQUAL):
+      CASE(IID_BR_BEQUAL):
+      CASE(IID_BR_SMEQUAL):
+      CASE(IID_BR_SMALLER):
+      CASE(IID_BR_BIGGER): {
+         int rel = current->IID - IID_BR_EQUAL;
+         int result;
+         CALL_CHECK(Relation(IID_EQUAL + rel, ARG2, ARG3, &result));
+
+         if (IS_INT(ARG2) && IS_INT(ARG3))
+            QUICKEN(IID_BR_INT_EQUAL + rel);
+         else if (ARG2->NID == NID_NUMBER && ARG3->NID == NID_NUMBER)
+            QUICKEN(IID_BR_NUM_EQUAL + rel);
+         else if (ARG2->NID == NID_STRING && ARG3->NID == NID_STRING && current->IID == IID_BR_EQUAL)
+            QUICKEN(IID_BR_STR_EQUAL);
+         else if (ARG2->NID == NID_STRING && ARG3->NID == NID_STRING && current->IID == IID_BR_UNEQUAL)
+            QUICKEN(IID_BR_STR_UNEQUAL);
+
+         if (!result) {
+            if (current->arg1 == NO_TARGET) {
+               errno = INTERNAL_ERROR;
+               return EXIT_FAILURE;
+            }
+            JUMP(current->arg1);
+         }
+         NEXT;
       }
-      T_ListSucc(list);
+
+      CASE(IID_BR_NUM_EQUAL):
+         if (ARG2->NID != NID_NUMBER || ARG3->NID != NID_NUMBER) {
+            current->IID = IID_BR_EQUAL;
+            REDISPATCH;
+         }
+         if (NUM_VAL(ARG2) != NUM_VAL(ARG3)) {
+            JUMP(current->arg1);
+         }
+         NEXT;
+
+      CASE(IID_BR_NUM_UNEQUAL):
+         if (ARG2->NID != NID_NUMBER || ARG3->NID != NID_NUMBER) {
+            current->IID = IID_BR_UNEQUAL;
+            REDISPATCH;
+         }
+         if (NUM_VAL(ARG2) == NUM_VAL(ARG3)) {
+            JUMP(current->arg1);
+         }
+         NEXT;
+
+      CASE(IID_BR_NUM_BEQUAL):
+         if (ARG2->NID != NID_NUMBER || ARG3->NID != NID_NUMBER) {
+            current->IID = IID_BR_BEQUAL;
+            REDISPATCH;
+         }
+         if (!(NUM_VAL(ARG2) >= NUM_VAL(ARG3))) {
+            JUMP(current->arg1);
+         }
+         NEXT;
+
+      CASE(IID_BR_NUM_SMEQUAL):
+         if (ARG2->NID != NID_NUMBER || ARG3->NID != NID_NUMBER) {
+            current->IID = IID_BR_SMEQUAL;
+            REDISPATCH;
+         }
+         if (!(NUM_VAL(ARG2) <= NUM_VAL(ARG3))) {
+            JUMP(current->arg1);
+         }
+         NEXT;
+
+      CASE(IID_BR_NUM_SMALLER):
+         if (ARG2->NID != NID_NUMBER || ARG3->NID != NID_NUMBER) {
+            current->IID = IID_BR_SMALLER;
+            REDISPATCH;
+         }
+         if (!(NUM_VAL(ARG2) < NUM_VAL(ARG3))) {
+            JUMP(current->arg1);
+         }
+         NEXT;
+
+      CASE(IID_BR_NUM_BIGGER):
+         if (ARG2->NID != NID_NUMBER || ARG3->NID != NID_NUMBER) {
+            current->IID = IID_BR_BIGGER;
+            REDISPATCH;
+         }
+         if (!(NUM_VAL(ARG2) > NUM_VAL(ARG3))) {
+            JUMP(current->arg1);
+         }
+         NEXT;
+
+      // retazce roznej dlzky sa nerovnaju, obsah sa porovnava az pri zhodnej dlzke
+      CASE(IID_BR_STR_EQUAL):
+         if (ARG2->NID != NID_STRING || ARG3->NID != NID_STRING) {
+            current->IID = IID_BR_EQUAL;
+            REDISPATCH;
+         }
+         if (VAR_LENGTH(ARG2) != VAR_LENGTH(ARG3)) {
+            JUMP(current->arg1);
+         }
+         // Prazdny retazec moze mat data NULL, memcmp() ich nesmie dostat
+         if (VAR_LENGTH(ARG2) != 0) {
+            FLATTEN(ARG2);
+            FLATTEN(ARG3);
+            if (memcmp(ARG2->vals.str.data, ARG3->vals.str.data, VAR_LENGTH(ARG2)) != 0) {
+               JUMP(current->arg1);
+            }
+         }
+         NEXT;
+
+      CASE(IID_BR_STR_UNEQUAL):
+         if (ARG2->NID != NID_STRING || ARG3->NID != NID_STRING) {
+            current->IID = IID_BR_UNEQUAL;
+            REDISPATCH;
+         }
+         if (VAR_LENGTH(ARG2) == 0 && VAR_LENGTH(ARG3) == 0) {
+            JUMP(current->arg1);
+         }
+         if (VAR_LENGTH(ARG2) == VAR_LENGTH(ARG3)) {
+            FLATTEN(ARG2);
+            FLATTEN(ARG3);
+            if (memcmp(ARG2->vals.str.data, ARG3->vals.str.data, VAR_LENGTH(ARG2)) == 0) {
+               JUMP(current->arg1);
+            }
+         }
+         NEXT;
+
+      // Celociselne porovnanie, oba operandy maju SUB_INT
+      CASE(IID_BR_INT_EQUAL):
+         if (!IS_INT(ARG2) || !IS_INT(ARG3)) {
+            current->IID = IID_BR_EQUAL;
+            REDISPATCH;
+         }
+         if (ARG2->vals.i_val != ARG3->vals.i_val) {
+            JUMP(current->arg1);
+         }
+         NEXT;
+
+      CASE(IID_BR_INT_UNEQUAL):
+         if (!IS_INT(ARG2) || !IS_INT(ARG3)) {
+            current->IID = IID_BR_UNEQUAL;
+            REDISPATCH;
+         }
+         if (ARG2->vals.i_val == ARG3->vals.i_val) {
+            JUMP(current->arg1);
+         }
+         NEXT;
+
+      CASE(IID_BR_INT_BEQUAL):
+         if (!IS_INT(ARG2) || !IS_INT(ARG3)) {
+            current->IID = IID_BR_BEQUAL;
+            REDISPATCH;
+         }
+         if (!(ARG2->vals.i_val >= ARG3->vals.i_val)) {
+            JUMP(current->arg1);
+         }
+         NEXT;
+
+      CASE(IID_BR_INT_SMEQUAL):
+         if (!IS_INT(ARG2) || !IS_INT(ARG3)) {
+            current->IID = IID_BR_SMEQUAL;
+            REDISPATCH;
+         }
+         if (!(ARG2->vals.i_val <= ARG3->vals.i_val)) {
+            JUMP(current->arg1);
+         }
+         NEXT;
+
+      CASE(IID_BR_INT_SMALLER):
+         if (!IS_INT(ARG2) || !IS_INT(ARG3)) {
+            current->IID = IID_BR_SMALLER;
+            REDISPATCH;
+         }
+         if (!(ARG2->vals.i_val < ARG3->vals.i_val)) {
+            JUMP(current->arg1);
+         }
+         NEXT;
+
+      CASE(IID_BR_INT_BIGGER):
+         if (!IS_INT(ARG2) || !IS_INT(ARG3)) {
+            current->IID = IID_BR_BIGGER;
+            REDISPATCH;
+         }
+         if (!(ARG2->vals.i_val > ARG3->vals.i_val)) {
+            JUMP(current->arg1);
+         }
+         NEXT;
+
+      // Koniec programu ---------------------------------------------------------------------------------------------
+      CASE(IID_HALT):
+         DEBUG_INTERPRET_END;
+         return EXIT_SUCCESS;
+
+#ifndef THREADED_DISPATCH
+      default:
+         NEXT;
+#endif
    }
+}
 
-   DEBUG_INTERPRET_END;
+/* Vykona program alebo pokracuje v pozastavenom behu, viz Run(). Beh,
+   ktory skoncil alebo zlyhal, sa dalsim volanim spusti od zaciatku.
+*/
+int Interpret(T_Context *ctx, uint64_t slice)
+{
+   int rc = Run(ctx, slice);
+   if (rc != INTERPRET_YIELD && ctx != NULL)
+      ctx->suspended = 0;
+   return rc;
+}
+
+// Prepise obsah inicializovaneho T_String retazcom c_str, buffer sa pouzije znova
+static int StringSet(T_String *str, const char *c_str)
+{
+   size_t length = strlen(c_str);
+   CALL_CHECK(T_StringReserve(str, length));
+   memcpy(str->data, c_str, length + 1);
+   STRING_HEAD(str)->length = length;
    return EXIT_SUCCESS;
 }
 
-/* Naplni T_String podla hodnoty NID T_Var.
+/* Naplni inicializovany T_String podla hodnoty NID T_Var.
    Vyuzite v interprete, pri konkatenacii retazcov.
 */
 int T_StringFill(T_String *str, T_Var var)
 {
    switch ( (int) var.NID) {
       case (int)NID_BOOL:
-         if (var.vals.b_val == 0) {
-            strcpy(str->data, "false");
-            str->length = strlen("false");
-         }
-         else {
-            strcpy(str->data, "true");
-            str->length = strlen("true");
-         }
-         break;
+         return StringSet(str, var.vals.b_val == 0 ? "false" : "true");
 
       case (int)NID_NIL:
-         strcpy(str->data, "Nil");
-         str->length = strlen("Nil");
-         break;
-
-      case (int)NID_NUMBER:
-         if (itoa(var.vals.d_val, str->data, DECIMAL_BASE) == EXIT_FAILURE) {
+         return StringSet(str, "Nil");
+
+      case (int)NID_NUMBER: {
+         // itoa() pise do obycajneho buffra, retazec ma dlzku v hlavicke
+         char *number = NULL;
+         int rc = itoa(NUM_VAL(&var), &number, DECIMAL_BASE);
+         if (rc == EXIT_SUCCESS)
+            rc = StringSet(str, number);
+         MemFree(number);
+         if (rc == EXIT_FAILURE) {
             errno = INTERNAL_ERROR;
             return EXIT_FAILURE;
          }
-         str->length = strlen(str->data);
          break;
+      }
 
       default:
          errno = SEMANTIC_ERROR;
@@ -692,13 +1350,61 @@ int T_StringFill(T_String *str, T_Var var)
    return EXIT_SUCCESS;
 }
 
+/* Vyhodnoti relaciu IID_EQUAL az IID_BIGGER nad a, b rovnako ako
+   samostatne relacne instrukcie v Interpret(), vratane chyb.
+   Vysledok (0 alebo 1) ulozi do result.
+*/
+static int Relation(int IID, T_Var *a, T_Var *b, int *result)
+{
+   if (a->NID == NID_UNDEF || b->NID == NID_UNDEF) {
+      errno = UNDEFINED_VARIABLE;
+      return EXIT_FAILURE;
+   }
+
+   FLATTEN(a);
+   FLATTEN(b);
+
+   if (IID == IID_EQUAL || IID == IID_UNEQUAL) {
+      if (a->NID == NID_CONST || a->NID == NID_FUNCTION || b->NID == NID_CONST || b->NID == NID_FUNCTION) {
+         errno = (IID == IID_EQUAL) ? TYPE_COMPATIBILITY_ERROR : UNDEFINED_VARIABLE;
+         return EXIT_FAILURE;
+      }
+      *result = RelType(*a, *b);
+      if (IID == IID_UNEQUAL)
+         *result = !*result;
+      return EXIT_SUCCESS;
+   }
+
+   double x, y;
+   if (a->NID == b->NID && a->NID == NID_NUMBER) {
+      x = NUM_VAL(a);
+      y = NUM_VAL(b);
+   }
+   else if (a->NID == b->NID && a->NID == NID_STRING) {
+      x = strcmp(a->vals.str.data, b->vals.str.data);
+      y = 0.0;
+   }
+   else {
+      errno = TYPE_COMPATIBILITY_ERROR;
+      return EXIT_FAILURE;
+   }
+
+   switch (IID) {
+      case IID_BEQUAL:  *result = (x >= y); break;
+      case IID_SMEQUAL: *result = (x <= y); break;
+      case IID_SMALLER: *result = (x < y); break;
+      default:          *result = (x > y); break;
+   }
+   return EXIT_SUCCESS;
+}
+
 int RelType(T_Var arg1, T_Var arg2)
 {
    if ((arg1.NID == arg2.NID) && arg1.NID == NID_STRING && (strcmp(arg1.vals.str.data, arg2.vals.str.data) == 0))
       return 1;  // true
    else if ((arg1.NID == arg2.NID) && arg1.NID == NID_BOOL && (arg1.vals.b_val == arg2.vals.b_val))
       return 1; // true
-   else if ((arg1.NID == arg2.NID) && arg1.NID == NID_NUMBER && (arg1.vals.d_val == arg2.vals.d_val))
+   else if ((arg1.NID == arg2.NID) && arg1.NID == NID_NUMBER && (NUM_VAL(&arg1) == NUM_VAL(&arg2)))
       return 1;  // true
 
    return 0; // false
@@ -780,28 +1486,107 @@ void OperationPrint(int op) {
       case IID_SORT:
          printf("  Operacia: SORT \n");
          break;
+      case IID_HALT:
+         printf("  Operacia: HALT \n");
+         break;
+      case IID_PLUS_NUM:
+         printf("  Operacia: PLUS_NUM \n");
+         break;
+      case IID_PLUS_STR:
+         printf("  Operacia: PLUS_STR \n");
+         break;
+      case IID_DIFF_NUM:
+         printf("  Operacia: DIFF_NUM \n");
+         break;
+      case IID_MUL_NUM:
+         printf("  Operacia: MUL_NUM \n");
+         break;
+      case IID_DIV_NUM:
+         printf("  Operacia: DIV_NUM \n");
+         break;
+      case IID_PWR_NUM:
+         printf("  Operacia: PWR_NUM \n");
+         break;
+      case IID_BR_EQUAL:
+         printf("  Operacia: BR_EQUAL \n");
+         break;
+      case IID_BR_UNEQUAL:
+         printf("  Operacia: BR_UNEQUAL \n");
+         break;
+      case IID_BR_BEQUAL:
+         printf("  Operacia: BR_BEQUAL \n");
+         break;
+      case IID_BR_SMEQUAL:
+         printf("  Operacia: BR_SMEQUAL \n");
+         break;
+      case IID_BR_SMALLER:
+         printf("  Operacia: BR_SMALLER \n");
+         break;
+      case IID_BR_BIGGER:
+         printf("  Operacia: BR_BIGGER \n");
+         break;
+      case IID_BR_NUM_EQUAL:
+         printf("  Operacia: BR_NUM_EQUAL \n");
+         break;
+      case IID_BR_NUM_UNEQUAL:
+         printf("  Operacia: BR_NUM_UNEQUAL \n");
+         break;
+      case IID_BR_NUM_BEQUAL:
+         printf("  Operacia: BR_NUM_BEQUAL \n");
+         break;
+      case IID_BR_NUM_SMEQUAL:
+         printf("  Operacia: BR_NUM_SMEQUAL \n");
+         break;
+      case IID_BR_NUM_SMALLER:
+         printf("  Operacia: BR_NUM_SMALLER \n");
+         break;
+      case IID_BR_NUM_BIGGER:
+         printf("  Operacia: BR_NUM_BIGGER \n");
+         break;
+      case IID_BR_STR_EQUAL:
+         printf("  Operacia: BR_STR_EQUAL \n");
+         break;
+      case IID_BR_STR_UNEQUAL:
+         printf("  Operacia: BR_STR_UNEQUAL \n");
+         break;
+      case IID_PLUS_INT:
+         printf("  Operacia: PLUS_INT \n");
+         break;
+      case IID_DIFF_INT:
+         printf("  Operacia: DIFF_INT \n");
+         break;
+      case IID_MUL_INT:
+         printf("  Operacia: MUL_INT \n");
+         break;
+      case IID_DIV_INT:
+         printf("  Operacia: DIV_INT \n");
+         break;
+      case IID_LOOP:
+         printf("  Operacia: LOOP \n");
+         break;
+      case IID_APPEND:
+         printf("  Operacia: APPEND \n");
+         break;
+      case IID_BR_INT_EQUAL:
+         printf("  Operacia: BR_INT_EQUAL \n");
+         break;
+      case IID_BR_INT_UNEQUAL:
+         printf("  Operacia: BR_INT_UNEQUAL \n");
+         break;
+      case IID_BR_INT_BEQUAL:
+         printf("  Operacia: BR_INT_BEQUAL \n");
+         break;
+      case IID_BR_INT_SMEQUAL:
+         printf("  Operacia: BR_INT_SMEQUAL \n");
+         break;
+      case IID_BR_INT_SMALLER:
+         printf("  Operacia: BR_INT_SMALLER \n");
+         break;
+      case IID_BR_INT_BIGGER:
+         printf("  Operacia: BR_INT_BIGGER \n");
+         break;
       default:
          printf("  Operacia: !!! uknown !!! \n");
          break;
    }
 }
-
-int Jump(T_List *list, T_LabelList *lbl_list, T_Var *var)
-{
-   if (var->NID == NID_STRING) {
-      T_LabelItem *pom = lbl_list->first;
-
-      while (pom != NULL) {
-         if (strcmp((*pom->ptr_label)->data->arg1->vals.str.data, var->vals.str.data) == 0) {
-            list->actual = (*pom->ptr_label);
-            return EXIT_SUCCESS;
-         }
-         else {
-            pom = pom->next;
-         }
-      }
-   }
-
-   errno = INTERNAL_ERROR;
-   return EXIT_FAILURE;
-}
@@ -44,14 +44,69 @@ enum { // Numeric instruction identification
    IID_TYPEOF, //                                                 23
    IID_LEN, //                                                    24
    IID_FIND, //                                                   25
-   IID_SORT //                                                    26
+   IID_SORT, //                                                   26
+
+   IID_HALT, // End of program, last instruction of T_Program     27
+
+   // Quickened variants, Interpret() rewrites generic ones at run time
+   IID_PLUS_NUM, // Number + number                               28
+   IID_PLUS_STR, // String + string                               29
+   IID_DIFF_NUM, // Number - number                               30
+   IID_MUL_NUM, // Number * number                                31
+   IID_DIV_NUM, // Number / number                                32
+   IID_PWR_NUM, // Number ** number                               33
+
+   // Fused relation + IID_BRAFAL, branch if the relation is false (Optimize())
+   IID_BR_EQUAL, //                                               34
+   IID_BR_UNEQUAL, //                                             35
+   IID_BR_BEQUAL, //                                              36
+   IID_BR_SMEQUAL, //                                             37
+   IID_BR_SMALLER, //                                             38
+   IID_BR_BIGGER, //                                              39
+
+   // Quickened fused variants, same order as the generic ones
+   IID_BR_NUM_EQUAL, //                                           40
+   IID_BR_NUM_UNEQUAL, //                                         41
+   IID_BR_NUM_BEQUAL, //                                          42
+   IID_BR_NUM_SMEQUAL, //                                         43
+   IID_BR_NUM_SMALLER, //                                         44
+   IID_BR_NUM_BIGGER, //                                          45
+   IID_BR_STR_EQUAL, // Compares lengths first                    46
+   IID_BR_STR_UNEQUAL, //                                         47
+
+   // Quickened integer variants, operands hold SUB_INT numbers
+   IID_PLUS_INT, //                                               48
+   IID_DIFF_INT, //                                               49
+   IID_MUL_INT, //                                                50
+   IID_DIV_INT, //                                                51
+
+   // Backward IID_JUMP of a run with limits, see Interpret()
+   IID_LOOP, //                                                   52
+
+   // x = x + e in place, arg1 is both the target and the left operand (Optimize())
+   IID_APPEND, //                                                 53
+
+   // Quickened fused variants for two SUB_INT operands, same order as the generic ones
+   IID_BR_INT_EQUAL, //                                           54
+   IID_BR_INT_UNEQUAL, //                                         55
+   IID_BR_INT_BEQUAL, //                                          56
+   IID_BR_INT_SMEQUAL, //                                         57
+   IID_BR_INT_SMALLER, //                                         58
+   IID_BR_INT_BIGGER, //                                          59
+
+   IID_COUNT // Number of instructions
 };
 
 int T_InstrInit(T_Instr *instr);
 void T_InstrDelete(T_Instr *instr);
 int T_InstrSet(T_Instr *instr, int IID, T_Var *arg1, T_Var *arg2, T_Var *arg3);
 
-int Interpret(T_List *list, T_LabelList *lbl_list);
+// Interpret() stopped after its slice, the context holds where to continue
+#define INTERPRET_YIELD 2
+
+int Interpret(T_Context *ctx, uint64_t slice);
+// Generic instruction a quickened variant or IID_LOOP was rewritten from
+int GenericIID(int IID);
 
 //int T_StringFill(T_String *str, T_Var var);
 //void OperationPrint(int op);
@@ -7,6 +7,8 @@
 //
 ///////////////////////////////////////////////////////////////////////////////
 
+#define _POSIX_C_SOURCE 200809L // fmemopen()
+
 #include <errno.h>
 #include <stdlib.h>
 #include <stdio.h>
@@ -39,14 +41,38 @@ enum { // Lexical analyzer states
    LEX_COMMENT_STAR,
 };
 
-FILE *fd;
+int LexInit(T_Context *ctx, char *filename)
+{
+   DEBUG_LEX_INIT;
+   PTR_CHECK(ctx);
+   ctx->fd = fopen(filename, "r");
+
+   if (ctx->fd == NULL) {
+      errno = INTERNAL_ERROR;
+      return EXIT_FAILURE;
+   }
 
-int LexInit(char *filename)
+   DEBUG_LEX_INIT_END;
+   return EXIT_SUCCESS;
+}
+
+/* Lexer cita zdrojovy text z pamate (fmemopen()), text musi zostat
+   platny az do LexFinish().
+*/
+int LexInitBuffer(T_Context *ctx, const char *source, size_t length)
 {
    DEBUG_LEX_INIT;
-   fd = fopen(filename, "r");
+   PTR_CHECK(ctx);
+   PTR_CHECK(source);
+
+   // Prazdny buffer fmemopen() neotvori, prazdny program je jeden riadok
+   if (length == 0) {
+      source = "\n";
+      length = 1;
+   }
+   ctx->fd = fmemopen((void *)source, length, "r");
 
-   if (fd == NULL) {
+   if (ctx->fd == NULL) {
       errno = INTERNAL_ERROR;
       return EXIT_FAILURE;
    }
@@ -55,16 +81,18 @@ int LexInit(char *filename)
    return EXIT_SUCCESS;
 }
 
-void LexFinish()
+void LexFinish(T_Context *ctx)
 {
    DEBUG_LEX_FINISH;
 
-   fclose(fd);
+   if (ctx->fd != NULL)
+      fclose(ctx->fd);
+   ctx->fd = NULL;
 
    DEBUG_LEX_FINISH_END;
 }
 
-int GetToken(T_String *token)
+int GetToken(T_Context *ctx, T_String *token)
 {
    DEBUG_GET_TOKEN;
    if (token == NULL) {
@@ -80,8 +108,8 @@ int GetToken(T_String *token)
    CALL_CHECK(T_StringInit(token));
 
    while (1) {
-      c = fgetc(fd);
-      if (ferror(fd)) {
+      c = fgetc(ctx->fd);
+      if (ferror(ctx->fd)) {
          errno = INTERNAL_ERROR;
          DEBUG_GET_TOKEN_END;
          return TOKEN_PROBLEM;
@@ -167,7 +195,7 @@ int GetToken(T_String *token)
             T_StringAppend(token, c);
 
          else {
-            ungetc(c, fd);
+            ungetc(c, ctx->fd);
             DEBUG_GET_TOKEN_END;
             return TOKEN_IDENTIFICATOR;
          }
@@ -196,7 +224,7 @@ int GetToken(T_String *token)
 //---------------------------------------------------------------------------------
       case LEX_NUM_DEC:
          if ((isspace(c)) || (c == '+') || (c == '-') || (c == '*') || (c == '/') || (c == ':') || (c == ')') || (c == ']') || (c == EOF)) {
-            ungetc(c, fd);
+            ungetc(c, ctx->fd);
             DEBUG_GET_TOKEN_END;
             return TOKEN_NUMBER;
          }
@@ -266,7 +294,7 @@ int GetToken(T_String *token)
          }
 
          else {
-            ungetc(c,fd);
+            ungetc(c,ctx->fd);
             errno = LEXICAL_ERROR;
             DEBUG_GET_TOKEN_END;
             return TOKEN_BROKEN;
@@ -280,7 +308,7 @@ int GetToken(T_String *token)
          }
 
          else {
-            ungetc(c,fd);
+            ungetc(c,ctx->fd);
             DEBUG_GET_TOKEN_END;
             return TOKEN_ASSIGN;
          }
@@ -293,7 +321,7 @@ int GetToken(T_String *token)
         }
 
         else {
-            ungetc(c,fd);
+            ungetc(c,ctx->fd);
             DEBUG_GET_TOKEN_END;
             return TOKEN_SMALLER;
         }
@@ -306,7 +334,7 @@ int GetToken(T_String *token)
          }
 
          else {
-             ungetc(c,fd);
+             ungetc(c,ctx->fd);
              DEBUG_GET_TOKEN_END;
              return TOKEN_BIGGER;
          }
@@ -319,7 +347,7 @@ int GetToken(T_String *token)
          }
 
          else {
-            ungetc(c,fd);
+            ungetc(c,ctx->fd);
             DEBUG_GET_TOKEN_END;
             return TOKEN_STAR;
          }
@@ -337,7 +365,7 @@ int GetToken(T_String *token)
             state=LEX_COMMENT;
 
          else {
-            ungetc(c,fd);
+            ungetc(c,ctx->fd);
             DEBUG_GET_TOKEN_END;
             return TOKEN_SLASH;
          }
@@ -390,9 +418,9 @@ int GetToken(T_String *token)
    return TOKEN_PROBLEM;
 }
 
-int PutBack(int c)
+int PutBack(T_Context *ctx, int c)
 {
-   if (ungetc(c, fd) == EOF) {
+   if (ungetc(c, ctx->fd) == EOF) {
       errno = INTERNAL_ERROR;
       return EXIT_FAILURE;
    }
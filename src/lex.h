@@ -116,9 +116,10 @@ enum { // Token types -- return values
    TOKEN_EOF,
 };
 
-int LexInit(char *filename);
-void LexFinish();
-int PutBack(int c);
-int GetToken(T_String *token);
+int LexInit(T_Context *ctx, char *filename);
+int LexInitBuffer(T_Context *ctx, const char *source, size_t length);
+void LexFinish(T_Context *ctx);
+int PutBack(T_Context *ctx, int c);
+int GetToken(T_Context *ctx, T_String *token);
 
 #endif
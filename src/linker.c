@@ -0,0 +1,318 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+//  Falcon Interpreter
+//
+//  for Formal Languages and Compilers 2012/2013
+//  by Varga Tomas, Vojvoda Jakub, Nesvadba Tomas, Spanko Jaroslav, Warzel Adam
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <stdint.h>
+#include <ctype.h>
+
+#include "alloc.h"
+#include "linker.h"
+#include "interpret.h"
+#include "types.h"
+#include "codes.h"
+#include "macros.h"
+#include "ial.h"
+
+/* Navestia zoradene podla mena, rovnake mena v poradi zoznamu navesti,
+   aby skok nasiel to iste navestie ako pri prechode zoznamom.
+*/
+typedef struct {
+   const char *name;
+   uint32_t order;
+   T_ListItem *label;
+} T_LabelEntry;
+
+static int LabelCompare(const void *a, const void *b)
+{
+   const T_LabelEntry *x = a;
+   const T_LabelEntry *y = b;
+   int rc = strcmp(x->name, y->name);
+   return (rc != 0) ? rc : (x->order > y->order) - (x->order < y->order);
+}
+
+static int LabelIndex(T_LabelList *lbl_list, T_LabelEntry **labels, uint32_t *count)
+{
+   *count = 0;
+   for (T_LabelItem *pom = lbl_list->first; pom != NULL; pom = pom->next)
+      (*count)++;
+
+   if ((*labels = MemAlloc((*count + 1) * sizeof(T_LabelEntry))) == NULL) {
+      errno = INTERNAL_ERROR;
+      return EXIT_FAILURE;
+   }
+
+   uint32_t i = 0;
+   for (T_LabelItem *pom = lbl_list->first; pom != NULL; pom = pom->next, i++) {
+      (*labels)[i].name = (*pom->ptr_label)->data->arg1->vals.str.data;
+      (*labels)[i].order = i;
+      (*labels)[i].label = *pom->ptr_label;
+   }
+   qsort(*labels, *count, sizeof(T_LabelEntry), LabelCompare);
+   return EXIT_SUCCESS;
+}
+
+/* Vyhlada navestie so zadanym menom v indexe navesti.
+   Vrati polozku zoznamu instrukcii s IID_LABEL alebo NULL.
+*/
+static T_ListItem *FindLabel(T_LabelEntry *labels, uint32_t count, T_Var *name)
+{
+   if (name == NULL || name->NID != NID_STRING)
+      return NULL;
+
+   // Prve navestie s menom v intervale <low, high)
+   uint32_t low = 0;
+   uint32_t high = count;
+   while (low < high) {
+      uint32_t middle = low + (high - low) / 2;
+      if (strcmp(labels[middle].name, name->vals.str.data) < 0)
+         low = middle + 1;
+      else
+         high = middle;
+   }
+
+   if (low < count && strcmp(labels[low].name, name->vals.str.data) == 0)
+      return labels[low].label;
+   return NULL;
+}
+
+/* Tabulka, ktora priraduje premennym z prekladu sloty ramca.
+   Otvorene adresovanie podla adresy premennej, velkost je mocnina dvoch.
+*/
+typedef struct {
+   T_Var **vars;
+   int32_t *slots;
+   uint32_t mask;
+   uint32_t count;
+} T_SlotMap;
+
+static int SlotMapInit(T_SlotMap *map, uint32_t max_vars)
+{
+   uint32_t size = 16;
+   while (size < 2 * max_vars)
+      size *= 2;
+
+   map->vars = MemCalloc(size, sizeof(T_Var *));
+   map->slots = MemAlloc(size * sizeof(int32_t));
+   if (map->vars == NULL || map->slots == NULL) {
+      MemFree(map->vars);
+      MemFree(map->slots);
+      errno = INTERNAL_ERROR;
+      return EXIT_FAILURE;
+   }
+
+   map->mask = size - 1;
+   map->count = 0;
+   return EXIT_SUCCESS;
+}
+
+static void SlotMapDelete(T_SlotMap *map)
+{
+   MemFree(map->vars);
+   MemFree(map->slots);
+}
+
+// Index polozky premennej v tabulke (volna polozka, ak premenna nema slot)
+static uint32_t SlotIndex(T_SlotMap *map, T_Var *var)
+{
+   uint32_t i = (uint32_t)(((uintptr_t)var / sizeof(void *)) * 2654435761u) & map->mask;
+   while (map->vars[i] != NULL && map->vars[i] != var)
+      i = (i + 1) & map->mask;
+   return i;
+}
+
+// Vrati slot premennej, pri prvom vyskyte jej prideli novy
+static int32_t SlotOf(T_SlotMap *map, T_Var *var)
+{
+   if (var == NULL)
+      return NO_SLOT;
+
+   uint32_t i = SlotIndex(map, var);
+   if (map->vars[i] == NULL) {
+      map->vars[i] = var;
+      map->slots[i] = map->count++;
+   }
+
+   return map->slots[i];
+}
+
+static int GlobalCompare(const void *a, const void *b)
+{
+   return strcmp(((const T_Global *)a)->name, ((const T_Global *)b)->name);
+}
+
+/* Zapamata si mena premennych skriptu, ktore dostali slot, aby ich hostitel
+   mohol citat a nastavovat (T_ProgramGlobal()). Pomocne premenne a navestia
+   maju mena zacinajuce cislicou, konstanty (vyhradene slova) sa vynechaju.
+*/
+static int LinkGlobals(T_HashTable *id_table, T_SlotMap *map, T_Program *program)
+{
+   uint32_t count = 0;
+   for (int pass = 0; pass < 2; pass++) {
+      for (int i = 0; i < HASH_TABLE_SIZE; i++) {
+         for (T_HashItem *item = (*id_table)[i]; item != NULL; item = item->next) {
+            char *name = item->string->data;
+            if (item->var == NULL || item->var->NID == NID_CONST || !(isalpha((unsigned char)name[0]) || name[0] == '_'))
+               continue;
+
+            uint32_t j = SlotIndex(map, item->var);
+            if (map->vars[j] == NULL)
+               continue;
+
+            if (pass == 1) {
+               T_Global *global = &program->globals[program->nglobals];
+               if ((global->name = MemAlloc(strlen(name) + 1)) == NULL) {
+                  errno = INTERNAL_ERROR;
+                  return EXIT_FAILURE;
+               }
+               strcpy(global->name, name);
+               global->slot = map->slots[j];
+               program->nglobals++;
+            }
+            else
+               count++;
+         }
+      }
+
+      if (pass == 0 && count > 0 && (program->globals = MemAlloc(count * sizeof(T_Global))) == NULL) {
+         errno = INTERNAL_ERROR;
+         return EXIT_FAILURE;
+      }
+   }
+
+   if (program->nglobals > 0)
+      qsort(program->globals, program->nglobals, sizeof(T_Global), GlobalCompare);
+   return EXIT_SUCCESS;
+}
+
+/* Zlinkuje zoznam instrukcii do suvisleho pola programu. Navestia sa
+   do programu nedostanu, kazdy skok dostane namiesto mena navestia index
+   instrukcie, ktora nasleduje za navestim (aj spojene IID_BR_*, viz
+   Optimize()). Posledna instrukcia programu je IID_HALT, navestie na
+   konci programu ukazuje na nu.
+   Kazda premenna, konstanta a pomocna premenna, s ktorou instrukcie
+   pracuju, dostane slot ramca a jej obsah sa skopiruje do program->slots.
+   Program potom nezavisi na tabulkach symbolov prekladu, z id_table
+   (moze byt NULL) si zoberie len mena premennych skriptu.
+   Zoznamy instrukcii a navesti zostavaju, uvolni ich volajuci (arena
+   prekladu v Compile()).
+*/
+int Link(T_List *list, T_LabelList *lbl_list, T_HashTable *id_table, T_Program *program)
+{
+   PTR_CHECK(list);
+   PTR_CHECK(lbl_list);
+   PTR_CHECK(program);
+
+   // Ocislovanie instrukcii, navestie dostane index nasledujucej instrukcie
+   uint32_t size = 0;
+   for (T_ListItem *item = list->first; item != NULL; item = item->next) {
+      if (item->data->IID == IID_LABEL)
+         item->data->target = size;
+      else
+         size++;
+   }
+
+   // Prepojenie skokov na ocislovane navestia
+   T_LabelEntry *labels;
+   uint32_t nlabels;
+   CALL_CHECK(LabelIndex(lbl_list, &labels, &nlabels));
+
+   for (T_ListItem *item = list->first; item != NULL; item = item->next) {
+      T_Instr *instr = item->data;
+      T_ListItem *label = NULL;
+
+      if (instr->IID == IID_JUMP || (instr->IID >= IID_BR_EQUAL && instr->IID <= IID_BR_BIGGER))
+         label = FindLabel(labels, nlabels, instr->arg1);
+      else if (instr->IID == IID_BRAFAL)
+         label = FindLabel(labels, nlabels, instr->arg2);
+      else
+         continue;
+
+      instr->target = (label != NULL) ? label->data->target : NO_TARGET;
+   }
+   MemFree(labels);
+
+   // Pridelenie slotov a prepis instrukcii do pola bez navesti
+   T_SlotMap map;
+   CALL_CHECK(SlotMapInit(&map, 3 * size));
+
+   T_Code *code = MemAlloc((size + 1) * sizeof(T_Code));
+   if (code == NULL) {
+      SlotMapDelete(&map);
+      errno = INTERNAL_ERROR;
+      return EXIT_FAILURE;
+   }
+
+   uint32_t i = 0;
+   for (T_ListItem *item = list->first; item != NULL; item = item->next) {
+      T_Instr *instr = item->data;
+
+      switch (instr->IID) {
+         case IID_LABEL:
+            continue;
+         case IID_JUMP:
+            code[i].arg1 = instr->target;
+            code[i].arg2 = NO_SLOT;
+            code[i].arg3 = NO_SLOT;
+            break;
+         case IID_BRAFAL:
+            code[i].arg1 = SlotOf(&map, instr->arg1);
+            code[i].arg2 = instr->target;
+            code[i].arg3 = NO_SLOT;
+            break;
+         case IID_BR_EQUAL:   case IID_BR_UNEQUAL: case IID_BR_BEQUAL:
+         case IID_BR_SMEQUAL: case IID_BR_SMALLER: case IID_BR_BIGGER:
+            code[i].arg1 = instr->target;
+            code[i].arg2 = SlotOf(&map, instr->arg2);
+            code[i].arg3 = SlotOf(&map, instr->arg3);
+            break;
+         default:
+            code[i].arg1 = SlotOf(&map, instr->arg1);
+            code[i].arg2 = SlotOf(&map, instr->arg2);
+            code[i].arg3 = SlotOf(&map, instr->arg3);
+            break;
+      }
+      code[i++].IID = instr->IID;
+   }
+   code[i].IID = IID_HALT;
+   code[i].arg1 = NO_SLOT;
+   code[i].arg2 = NO_SLOT;
+   code[i].arg3 = NO_SLOT;
+
+   if (T_ProgramInit(program, size + 1, map.count) == EXIT_FAILURE) {
+      MemFree(code);
+      SlotMapDelete(&map);
+      return EXIT_FAILURE;
+   }
+   memcpy(program->code, code, (size + 1) * sizeof(T_Code));
+   MemFree(code);
+
+   // Pociatocny obsah slotov
+   for (uint32_t j = 0; j <= map.mask; j++) {
+      if (map.vars[j] == NULL)
+         continue;
+      T_Var *slot = &program->slots[map.slots[j]];
+      if (T_VarCopy(slot, map.vars[j]) == EXIT_FAILURE) {
+         SlotMapDelete(&map);
+         return EXIT_FAILURE;
+      }
+      // Zoznam parametrov funkcie patri prekladu, program ho nepotrebuje
+      if (slot->NID == NID_FUNCTION)
+         slot->vals.args = NULL;
+   }
+
+   if (id_table != NULL && LinkGlobals(id_table, &map, program) == EXIT_FAILURE) {
+      SlotMapDelete(&map);
+      return EXIT_FAILURE;
+   }
+
+   SlotMapDelete(&map);
+   return EXIT_SUCCESS;
+}
@@ -0,0 +1,17 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+//  Falcon Interpreter
+//
+//  for Formal Languages and Compilers 2012/2013
+//  by Varga Tomas, Vojvoda Jakub, Nesvadba Tomas, Spanko Jaroslav, Warzel Adam
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef LINKER_H
+#define LINKER_H
+
+#include "types.h"
+
+int Link(T_List *list, T_LabelList *lbl_list, T_HashTable *id_table, T_Program *program);
+
+#endif
@@ -0,0 +1,509 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+//  Falcon Interpreter
+//
+//  for Formal Languages and Compilers 2012/2013
+//  by Varga Tomas, Vojvoda Jakub, Nesvadba Tomas, Spanko Jaroslav, Warzel Adam
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+
+#include "alloc.h"
+#include "optimize.h"
+#include "interpret.h"
+#include "types.h"
+#include "codes.h"
+#include "macros.h"
+
+// Najviac prechodov vsetkych pravidiel, kym sa zoznam prestane menit
+#define OPT_MAX_PASSES 8
+// Najviac skokov, cez ktore sa pri jump threadingu prejde
+#define OPT_MAX_HOPS 16
+
+/* Pravidlo dostane zoznam instrukcii a navesti a pripocita pocet
+   odstranenych a na mieste zmenenych instrukcii.
+*/
+typedef int (*T_OptRule)(T_List *list, T_LabelList *lbl_list, uint32_t *removed, uint32_t *rewritten);
+
+/* Zoradene pole dvojic (adresa, polozka zoznamu) pre vyhladavanie
+   premennych, navesti a instrukcii podla adresy.
+*/
+typedef struct {
+   const void *key;
+   T_ListItem *item;
+} T_OptEntry;
+
+typedef struct {
+   T_OptEntry *entries;
+   uint32_t count;
+} T_OptIndex;
+
+static int IndexInit(T_OptIndex *index, uint32_t size)
+{
+   index->count = 0;
+   if ((index->entries = MemAlloc((size + 1) * sizeof(T_OptEntry))) == NULL) {
+      errno = INTERNAL_ERROR;
+      return EXIT_FAILURE;
+   }
+   return EXIT_SUCCESS;
+}
+
+static void IndexDelete(T_OptIndex *index)
+{
+   MemFree(index->entries);
+   index->entries = NULL;
+   index->count = 0;
+}
+
+static void IndexAdd(T_OptIndex *index, const void *key, T_ListItem *item)
+{
+   index->entries[index->count].key = key;
+   index->entries[index->count].item = item;
+   index->count++;
+}
+
+static int EntryCompare(const void *a, const void *b)
+{
+   uintptr_t x = (uintptr_t)((const T_OptEntry *)a)->key;
+   uintptr_t y = (uintptr_t)((const T_OptEntry *)b)->key;
+   return (x > y) - (x < y);
+}
+
+static void IndexSort(T_OptIndex *index)
+{
+   qsort(index->entries, index->count, sizeof(T_OptEntry), EntryCompare);
+}
+
+// Vrati prvu polozku s danym klucom alebo NULL
+static T_OptEntry *IndexFind(T_OptIndex *index, const void *key)
+{
+   uint32_t low = 0;
+   uint32_t high = index->count;
+
+   while (low < high) {
+      uint32_t mid = low + (high - low) / 2;
+      if ((uintptr_t)index->entries[mid].key < (uintptr_t)key)
+         low = mid + 1;
+      else
+         high = mid;
+   }
+
+   if (low < index->count && index->entries[low].key == key)
+      return &index->entries[low];
+   return NULL;
+}
+
+static uint32_t IndexCount(T_OptIndex *index, const void *key)
+{
+   T_OptEntry *entry = IndexFind(index, key);
+   uint32_t count = 0;
+
+   while (entry != NULL && entry < index->entries + index->count && entry->key == key) {
+      count++;
+      entry++;
+   }
+   return count;
+}
+
+static uint32_t ListSize(T_List *list)
+{
+   uint32_t size = 0;
+   for (T_ListItem *item = list->first; item != NULL; item = item->next)
+      size++;
+   return size;
+}
+
+// Odstrani polozku item zo zoznamu, prev je polozka pred nou alebo NULL
+static void ListRemove(T_List *list, T_ListItem *prev, T_ListItem *item)
+{
+   if (prev == NULL)
+      list->first = item->next;
+   else
+      prev->next = item->next;
+
+   if (list->last == item)
+      list->last = prev;
+   if (list->actual == item)
+      list->actual = NULL;
+
+   POOL_DELETE(T_Instr, item->data);
+   POOL_DELETE(T_ListItem, item);
+}
+
+/* Vrati adresu operandu s menom navestia, na ktore instrukcia skace,
+   pre ine instrukcie NULL. Generator pouziva pre navestie aj pre skoky
+   na neho tu istu premennu, navestia sa preto porovnavaju podla adresy.
+*/
+static T_Var **JumpLabel(T_Instr *instr)
+{
+   if (instr->IID == IID_JUMP || (instr->IID >= IID_BR_EQUAL && instr->IID <= IID_BR_BIGGER))
+      return &instr->arg1;
+   if (instr->IID == IID_BRAFAL)
+      return &instr->arg2;
+   return NULL;
+}
+
+// Index vsetkych pouziti premennych v operandoch, mena navesti sa nepocitaju
+static int UsesInit(T_List *list, T_OptIndex *uses)
+{
+   CALL_CHECK(IndexInit(uses, 3 * ListSize(list)));
+
+   for (T_ListItem *item = list->first; item != NULL; item = item->next) {
+      T_Instr *instr = item->data;
+      if (instr->IID == IID_LABEL)
+         continue;
+
+      T_Var **label = JumpLabel(instr);
+      T_Var **args[3] = { &instr->arg1, &instr->arg2, &instr->arg3 };
+      for (int i = 0; i < 3; i++) {
+         if (*args[i] != NULL && args[i] != label)
+            IndexAdd(uses, *args[i], item);
+      }
+   }
+
+   IndexSort(uses);
+   return EXIT_SUCCESS;
+}
+
+// Index navesti v zozname podla mena
+static int LabelsInit(T_List *list, T_OptIndex *labels)
+{
+   CALL_CHECK(IndexInit(labels, ListSize(list)));
+
+   for (T_ListItem *item = list->first; item != NULL; item = item->next) {
+      if (item->data->IID == IID_LABEL)
+         IndexAdd(labels, item->data->arg1, item);
+   }
+
+   IndexSort(labels);
+   return EXIT_SUCCESS;
+}
+
+/* Propagacia kopii: OP t, a, b; COPY x, t -> OP x, a, b.
+   Len pre aritmeticke instrukcie s tromi operandmi, ak t necita nic ine
+   a x nie je operandom a ani b (instrukcia by si ho pred citanim zmazala).
+   Relacie sa vynechavaju, lebo odmietaju nedefinovanu cielovu premennu.
+*/
+static int CopyPropagation(T_List *list, T_LabelList *lbl_list, uint32_t *removed, uint32_t *rewritten)
+{
+   (void)lbl_list;
+   (void)rewritten;
+
+   T_OptIndex uses;
+   CALL_CHECK(UsesInit(list, &uses));
+
+   for (T_ListItem *item = list->first; item != NULL; item = item->next) {
+      T_Instr *instr = item->data;
+      T_ListItem *next = item->next;
+
+      if (instr->IID < IID_PLUS || instr->IID > IID_PWR || instr->arg3 == NULL)
+         continue;
+      if (next == NULL || next->data->IID != IID_COPY || next->data->arg2 != instr->arg1)
+         continue;
+      if (next->data->arg1 == instr->arg2 || next->data->arg1 == instr->arg3)
+         continue;
+      if (IndexCount(&uses, instr->arg1) != 2)
+         continue;
+
+      instr->arg1 = next->data->arg1;
+      ListRemove(list, item, next);
+      (*removed)++;
+   }
+
+   IndexDelete(&uses);
+   return EXIT_SUCCESS;
+}
+
+/* Pripojenie na mieste: PLUS t, x, e; COPY x, t -> APPEND x, e.
+   Retazec x sa tak predlzuje vo svojom buffri namiesto dvoch kopii celeho
+   x pri kazdom s = s + e. Len ak t necita nic ine.
+*/
+static int SelfAppend(T_List *list, T_LabelList *lbl_list, uint32_t *removed, uint32_t *rewritten)
+{
+   (void)lbl_list;
+
+   T_OptIndex uses;
+   CALL_CHECK(UsesInit(list, &uses));
+
+   for (T_ListItem *item = list->first; item != NULL; item = item->next) {
+      T_Instr *instr = item->data;
+      T_ListItem *next = item->next;
+
+      if (instr->IID != IID_PLUS || instr->arg3 == NULL)
+         continue;
+      if (next == NULL || next->data->IID != IID_COPY || next->data->arg2 != instr->arg1)
+         continue;
+      if (next->data->arg1 != instr->arg2 || IndexCount(&uses, instr->arg1) != 2)
+         continue;
+
+      instr->IID = IID_APPEND;
+      instr->arg1 = instr->arg2;
+      instr->arg2 = instr->arg3;
+      instr->arg3 = NULL;
+      ListRemove(list, item, next);
+      (*removed)++;
+      (*rewritten)++;
+   }
+
+   IndexDelete(&uses);
+   return EXIT_SUCCESS;
+}
+
+/* Jump threading: skok na navestie, za ktorym je IID_JUMP, sa presmeruje
+   rovno na jeho ciel. IID_JUMP na navestie hned za nim sa odstrani.
+   Podmieneny skok sa presmeruje len dopredu, dozadu skace iba IID_JUMP
+   (na tom stavia kontrola limitov v Interpret()).
+*/
+static int JumpThreading(T_List *list, T_LabelList *lbl_list, uint32_t *removed, uint32_t *rewritten)
+{
+   (void)lbl_list;
+
+   T_OptIndex labels;
+   CALL_CHECK(LabelsInit(list, &labels));
+
+   // Poradie instrukcii v zozname, docasne v target (Link() ho prepise)
+   int order = 0;
+   for (T_ListItem *item = list->first; item != NULL; item = item->next)
+      item->data->target = order++;
+
+   for (T_ListItem *item = list->first; item != NULL; item = item->next) {
+      T_Var **label = JumpLabel(item->data);
+      if (label == NULL)
+         continue;
+
+      T_Var *start = *label;
+      for (int hops = 0; hops < OPT_MAX_HOPS; hops++) {
+         T_OptEntry *entry = IndexFind(&labels, *label);
+         if (entry == NULL)
+            break;
+
+         T_ListItem *dest = entry->item;
+         while (dest != NULL && dest->data->IID == IID_LABEL)
+            dest = dest->next;
+
+         if (dest == NULL || dest->data->IID != IID_JUMP || dest->data->arg1 == *label)
+            break;
+         if (item->data->IID != IID_JUMP) {
+            T_OptEntry *next = IndexFind(&labels, dest->data->arg1);
+            if (next == NULL || next->item->data->target <= item->data->target)
+               break;
+         }
+         *label = dest->data->arg1;
+      }
+
+      if (*label != start)
+         (*rewritten)++;
+   }
+
+   for (T_ListItem *item = list->first; item != NULL; item = item->next)
+      item->data->target = NO_TARGET;
+
+   T_ListItem *prev = NULL;
+   T_ListItem *item = list->first;
+   while (item != NULL) {
+      int to_next = 0;
+
+      if (item->data->IID == IID_JUMP) {
+         for (T_ListItem *pom = item->next; pom != NULL && pom->data->IID == IID_LABEL; pom = pom->next) {
+            if (pom->data->arg1 == item->data->arg1) {
+               to_next = 1;
+               break;
+            }
+         }
+      }
+
+      if (to_next) {
+         T_ListItem *next = item->next;
+         ListRemove(list, prev, item);
+         (*removed)++;
+         item = next;
+      }
+      else {
+         prev = item;
+         item = item->next;
+      }
+   }
+
+   IndexDelete(&labels);
+   return EXIT_SUCCESS;
+}
+
+/* Odstrani navestia zo zoznamu navesti, na ktore neskace ziadna instrukcia.
+   Ine navestia (napr. navratove body volani) sa nechavaju.
+*/
+static int DeadLabels(T_List *list, T_LabelList *lbl_list, uint32_t *removed, uint32_t *rewritten)
+{
+   (void)rewritten;
+
+   T_OptIndex refs;
+   T_OptIndex dead;
+   CALL_CHECK(IndexInit(&refs, ListSize(list)));
+   if (IndexInit(&dead, ListSize(list)) == EXIT_FAILURE) {
+      IndexDelete(&refs);
+      return EXIT_FAILURE;
+   }
+
+   for (T_ListItem *item = list->first; item != NULL; item = item->next) {
+      T_Var **label = JumpLabel(item->data);
+      if (label != NULL)
+         IndexAdd(&refs, *label, item);
+   }
+   IndexSort(&refs);
+
+   T_LabelItem *prev = NULL;
+   T_LabelItem *pom = lbl_list->first;
+   while (pom != NULL) {
+      T_LabelItem *next = pom->next;
+      T_ListItem *label = *pom->ptr_label;
+
+      if (IndexFind(&refs, label->data->arg1) == NULL) {
+         IndexAdd(&dead, label, label);
+
+         if (prev == NULL)
+            lbl_list->first = next;
+         else
+            prev->next = next;
+         if (lbl_list->last == pom)
+            lbl_list->last = prev;
+
+         POOL_DELETE(T_ListItem *, pom->ptr_label);
+         POOL_DELETE(T_LabelItem, pom);
+      }
+      else
+         prev = pom;
+      pom = next;
+   }
+   IndexSort(&dead);
+
+   T_ListItem *prev_item = NULL;
+   T_ListItem *item = list->first;
+   while (item != NULL) {
+      T_ListItem *next = item->next;
+      if (IndexFind(&dead, item) != NULL) {
+         ListRemove(list, prev_item, item);
+         (*removed)++;
+      }
+      else
+         prev_item = item;
+      item = next;
+   }
+
+   IndexDelete(&refs);
+   IndexDelete(&dead);
+   return EXIT_SUCCESS;
+}
+
+// Odstrani instrukcie medzi IID_JUMP a nasledujucim navestim
+static int UnreachableCode(T_List *list, T_LabelList *lbl_list, uint32_t *removed, uint32_t *rewritten)
+{
+   (void)lbl_list;
+   (void)rewritten;
+
+   for (T_ListItem *item = list->first; item != NULL; item = item->next) {
+      if (item->data->IID != IID_JUMP)
+         continue;
+
+      while (item->next != NULL && item->next->data->IID != IID_LABEL) {
+         ListRemove(list, item, item->next);
+         (*removed)++;
+      }
+   }
+
+   return EXIT_SUCCESS;
+}
+
+/* Spoji relacnu instrukciu s nasledujucim IID_BRAFAL nad jej vysledkom
+   do jednej instrukcie IID_BR_* (skok, ak relacia neplati). Fuzuje sa len
+   vtedy, ked vysledok relacie necita ziadna ina instrukcia. Operand arg1
+   spojenej instrukcie je meno navestia, arg2 a arg3 su povodne operandy relacie.
+*/
+static int CompareBranch(T_List *list, T_LabelList *lbl_list, uint32_t *removed, uint32_t *rewritten)
+{
+   (void)lbl_list;
+   (void)rewritten;
+
+   T_OptIndex uses;
+   CALL_CHECK(UsesInit(list, &uses));
+
+   for (T_ListItem *item = list->first; item != NULL; item = item->next) {
+      T_Instr *instr = item->data;
+      T_ListItem *next = item->next;
+
+      if (instr->IID < IID_EQUAL || instr->IID > IID_BIGGER || instr->arg1 == NULL)
+         continue;
+      if (next == NULL || next->data->IID != IID_BRAFAL || next->data->arg1 != instr->arg1)
+         continue;
+      if (IndexCount(&uses, instr->arg1) != 2)
+         continue;
+
+      instr->IID = IID_BR_EQUAL + (instr->IID - IID_EQUAL);
+      instr->arg1 = next->data->arg2;
+      ListRemove(list, item, next);
+      (*removed)++;
+   }
+
+   IndexDelete(&uses);
+   return EXIT_SUCCESS;
+}
+
+static const T_OptRule rules[OPT_COUNT] = {
+   [OPT_COPY_PROPAGATION] = CopyPropagation,
+   [OPT_SELF_APPEND] = SelfAppend,
+   [OPT_JUMP_THREADING] = JumpThreading,
+   [OPT_DEAD_LABELS] = DeadLabels,
+   [OPT_UNREACHABLE_CODE] = UnreachableCode,
+   [OPT_COMPARE_BRANCH] = CompareBranch,
+};
+
+static const char *rule_names[OPT_COUNT] = {
+   [OPT_COPY_PROPAGATION] = "copy propagation",
+   [OPT_SELF_APPEND] = "self append",
+   [OPT_JUMP_THREADING] = "jump threading",
+   [OPT_DEAD_LABELS] = "dead labels",
+   [OPT_UNREACHABLE_CODE] = "unreachable code",
+   [OPT_COMPARE_BRANCH] = "compare-branch fusion",
+};
+
+/* Peephole optimalizacia zoznamu instrukcii medzi Synan() a Link().
+   Pravidla z tabulky rules sa opakuju, kym niektore z nich zoznam meni.
+   Nove pravidlo sa prida do enumu v optimize.h a do tabuliek vyssie.
+*/
+int Optimize(T_List *list, T_LabelList *lbl_list, T_OptStats *stats)
+{
+   PTR_CHECK(list);
+   PTR_CHECK(lbl_list);
+   PTR_CHECK(stats);
+
+   memset(stats, 0, sizeof(T_OptStats));
+   stats->before = ListSize(list);
+
+   for (int pass = 0; pass < OPT_MAX_PASSES; pass++) {
+      uint32_t changes = 0;
+
+      for (int i = 0; i < OPT_COUNT; i++) {
+         uint32_t removed = 0;
+         uint32_t rewritten = 0;
+
+         CALL_CHECK(rules[i](list, lbl_list, &removed, &rewritten));
+         stats->removed[i] += removed;
+         stats->rewritten[i] += rewritten;
+         changes += removed + rewritten;
+      }
+
+      if (changes == 0)
+         break;
+   }
+
+   stats->after = ListSize(list);
+   return EXIT_SUCCESS;
+}
+
+void OptimizeStatsPrint(T_OptStats *stats, FILE *fd)
+{
+   fprintf(fd, "optimize: %u -> %u instructions\n", stats->before, stats->after);
+   for (int i = 0; i < OPT_COUNT; i++)
+      fprintf(fd, "  %-22s removed %u, rewritten %u\n", rule_names[i], stats->removed[i], stats->rewritten[i]);
+}
@@ -0,0 +1,39 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+//  Falcon Interpreter
+//
+//  for Formal Languages and Compilers 2012/2013
+//  by Varga Tomas, Vojvoda Jakub, Nesvadba Tomas, Spanko Jaroslav, Warzel Adam
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef OPTIMIZE_H
+#define OPTIMIZE_H
+
+#include <stdio.h>
+#include <stdint.h>
+
+#include "types.h"
+
+enum { // Peephole rules, in the order Optimize() runs them
+   OPT_COPY_PROPAGATION,
+   OPT_SELF_APPEND,
+   OPT_JUMP_THREADING,
+   OPT_DEAD_LABELS,
+   OPT_UNREACHABLE_CODE,
+   OPT_COMPARE_BRANCH,
+
+   OPT_COUNT // Number of rules
+};
+
+typedef struct {
+   uint32_t before; // Instructions before optimization
+   uint32_t after; // Instructions after optimization
+   uint32_t removed[OPT_COUNT]; // Instructions removed by each rule
+   uint32_t rewritten[OPT_COUNT]; // Instructions changed in place by each rule
+} T_OptStats;
+
+int Optimize(T_List *list, T_LabelList *lbl_list, T_OptStats *stats);
+void OptimizeStatsPrint(T_OptStats *stats, FILE *fd);
+
+#endif
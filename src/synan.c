@@ -12,6 +12,7 @@
 #include <errno.h>
 #include <math.h>
 
+#include "alloc.h"
 #include "synan.h"
 #include "lex.h"
 #include "ial.h"
@@ -26,316 +27,322 @@
 #define MODE_OUTSIDE 1
 #define MODE_INSIDE 2
 
+// Najdlhsi retazec, ktory sa pri skladani konstant vytvori uz pri preklade
+#define FOLD_STRING_MAX 4096
+
 #define GenerateInstruction(type, arg1, arg2, arg3) \
-   T_InstrSet(&instr, type, arg1, arg2, arg3); \
-   T_ListAppend(inst_list, &instr)
+   T_InstrSet(&ctx->instr, type, arg1, arg2, arg3); \
+   T_ListAppend(ctx->inst_list, &ctx->instr)
 
 #define BRACKET_CHECK do {\
-   if (lex_rc != TOKEN_RBRACKET) { \
+   if (ctx->lex_rc != TOKEN_RBRACKET) { \
       errno = SYNTACTIC_ERROR; \
       return EXIT_FAILURE; \
    } \
 } while (0)
 
 #define TOKEN_CHECK \
-   if (lex_rc == TOKEN_BROKEN || lex_rc == TOKEN_PROBLEM) return EXIT_FAILURE;
-
-T_HashTable *kw_table;
-T_HashTable *builtin_table;
-T_HashTable *id_table;
-
-T_List *inst_list;
-T_AllocList *alloc_list;
-T_IdList *table_list;
-T_LabelList *lbl_list;
-T_LabelList *cal_list;
-
-T_Var *read_var;
-T_Var *write_var;
-
-T_Instr instr;
-T_String token;
-
-int lex_rc;
-int parentheses;
-int params_count;
-int tmp_count;
-
-int stat(int mode);
-int keyword(int mode);
-int expr();
-int item();
-int it_list(T_ArgItem *item_arg);
-int print_list();
-int if_state(int mode, T_Var *jmp);
-int while_state(T_Var *start_lbl, T_Var *end_lbl);
-int op();
-
-int SynanInit(T_List *instr_list, T_AllocList *al_list, T_LabelList *label_list)
+   if (ctx->lex_rc == TOKEN_BROKEN || ctx->lex_rc == TOKEN_PROBLEM) return EXIT_FAILURE;
+
+static int stat(T_Context *ctx, int mode);
+int keyword(T_Context *ctx, int mode);
+int expr(T_Context *ctx);
+int item(T_Context *ctx);
+int it_list(T_Context *ctx, T_ArgItem *item_arg);
+int print_list(T_Context *ctx);
+int if_state(T_Context *ctx, int mode, T_Var *jmp);
+int while_state(T_Context *ctx, T_Var *start_lbl, T_Var *end_lbl);
+int op(T_Context *ctx);
+
+int SynanInit(T_Context *ctx, T_List *instr_list, T_LabelList *label_list)
 {
    DEBUG_SYNAN_INIT;
 
-   write_var = NULL;
-   read_var = NULL;
-
-   kw_table = malloc(sizeof(T_HashTable));
-   builtin_table = malloc(sizeof(T_HashTable));
-   id_table = malloc(sizeof(T_HashTable));
-   table_list = malloc(sizeof(T_IdList));
-
-   T_Var *var = malloc(sizeof(T_Var));
-
-   if (kw_table == NULL || builtin_table == NULL || id_table == NULL || table_list == NULL || var == NULL || cal_list) {
-      free(kw_table);
-      free(builtin_table);
-      free(id_table);
-      free(table_list);
-      free(var);
-      free(cal_list);
+   ctx->write_var = NULL;
+   ctx->read_var = NULL;
+   ctx->lex_rc = TOKEN_PROBLEM;
+   ctx->parentheses = 0;
+   ctx->params_count = 0;
+   ctx->tmp_count = 0;
+
+   ctx->kw_table = MemAlloc(sizeof(T_HashTable));
+   ctx->builtin_table = MemAlloc(sizeof(T_HashTable));
+   ctx->id_table = MemAlloc(sizeof(T_HashTable));
+   ctx->table_list = MemAlloc(sizeof(T_IdList));
+   ctx->cal_list = MemAlloc(sizeof(T_LabelList));
+
+   T_Var *var = POOL_NEW(T_Var);
+
+   if (ctx->kw_table == NULL || ctx->builtin_table == NULL || ctx->id_table == NULL || ctx->table_list == NULL || var == NULL || ctx->cal_list == NULL) {
+      MemFree(ctx->kw_table);
+      MemFree(ctx->builtin_table);
+      MemFree(ctx->id_table);
+      MemFree(ctx->table_list);
+      POOL_DELETE(T_Var, var);
+      MemFree(ctx->cal_list);
+      errno = INTERNAL_ERROR;
+      return EXIT_FAILURE;
    }
 
-   T_LabelListInit(cal_list);
+   T_IdListInit(ctx->table_list);
+   T_LabelListInit(ctx->cal_list);
 
    // Saves reserved keywords into an identificator table as constants.
    T_VarInit(var);
    var->NID = NID_CONST;
 
    char *reserved[] = {"as", "def", "directive", "export", "from", "import", "launch", "load", "macro", "input", "print", "numeric", "typeOf", "len", ""};
-   T_HTableInit(id_table);
+   T_HTableInit(ctx->id_table);
    for (int i = 0; strcmp(reserved[i], "") != 0; i++)
-      T_HTableInsert(id_table, reserved[i], var);
+      T_HTableInsert(ctx->id_table, reserved[i], var);
 
    var->NID = NID_FUNCTION;
-   var->vals.args.size = 0;
+   var->vals.args = NULL;
 
    char *builtin[] = {"input", "print", "numeric", "typeOf", "len", ""};
-   T_HTableInit(builtin_table);
+   T_HTableInit(ctx->builtin_table);
    for (int i = 0; strcmp(builtin[i], "") != 0; i++)
-      T_HTableInsert(builtin_table, builtin[i], var);
+      T_HTableInsert(ctx->builtin_table, builtin[i], var);
 
    var->NID = NID_UNDEF;
-   T_HTableInsert(id_table, "0ret", var);
+   T_HTableInsert(ctx->id_table, "0ret", var);
 
    T_VarDelete(var);
-   free(var);
+   POOL_DELETE(T_Var, var);
 
    // Saves usable keywords
    char *keywords[] = {"else", "end", "false", "function", "if", "nil", "return", "true", "while", ""};
-   T_HTableInit(kw_table);
+   T_HTableInit(ctx->kw_table);
    for (int i = 0; strcmp(keywords[i], "") != 0; i++)
-      T_HTableInsert(kw_table, keywords[i], NULL);
+      T_HTableInsert(ctx->kw_table, keywords[i], NULL);
+
+   // Variables set by the host before compilation are already defined
+   if (ctx->globals != NULL) {
+      for (int i = 0; i < HASH_TABLE_SIZE; i++)
+         for (T_HashItem *item = (*ctx->globals)[i]; item != NULL; item = item->next)
+            CALL_CHECK(T_HTableInsert(ctx->id_table, item->string->data, item->var));
+   }
 
    // Initializing common variables
-   inst_list = instr_list;
-   alloc_list = al_list;
-   lbl_list = label_list;
+   ctx->inst_list = instr_list;
+   ctx->lbl_list = label_list;
 
-   T_InstrInit(&instr);
-   T_StringInit(&token);
+   T_InstrInit(&ctx->instr);
+   T_StringInit(&ctx->token);
 
    DEBUG_SYNAN_INIT_END;
    return EXIT_SUCCESS;
 }
 
-void SynanFinish()
+/* Stav parsera lezi v arene prekladu, ktoru uvolni naraz Compile().
+   Tu sa len odpoja ukazovatele kontextu, aby nezostali visiet.
+*/
+void SynanFinish(T_Context *ctx)
 {
    DEBUG_SYNAN_FINISH;
 
-   T_HTableDelete(kw_table);
-   T_HTableDelete(id_table);
-   T_LabelListDelete(cal_list);
-   free(kw_table);
-   free(id_table);
+   ctx->kw_table = NULL;
+   ctx->builtin_table = NULL;
+   ctx->id_table = NULL;
+   ctx->table_list = NULL;
+   ctx->cal_list = NULL;
+   ctx->inst_list = NULL;
+   ctx->lbl_list = NULL;
+   ctx->read_var = NULL;
+   ctx->write_var = NULL;
+   ctx->token.data = NULL;
 
    DEBUG_SYNAN_FINISH_END;
 }
 
-int GenerateVariable(int label, T_Var **var)
+int GenerateVariable(T_Context *ctx, int label, T_Var **var)
 {
    DEBUG_VAR_GEN(var);
-   char *var_name = malloc(sizeof(char));
-   T_Var *tmp_var = malloc(sizeof(T_Var));
+   char *var_name = MemAlloc(sizeof(char));
+   T_Var *tmp_var = POOL_NEW(T_Var);
 
    if (var_name == NULL || tmp_var == NULL) {
-      free(var_name);
-      free(tmp_var);
+      MemFree(var_name);
+      POOL_DELETE(T_Var, tmp_var);
       errno = INTERNAL_ERROR;
       return EXIT_FAILURE;
    }
 
    T_VarInit(tmp_var);
 
-   if (itoa(tmp_count++, var_name, DECIMAL_BASE) != EXIT_FAILURE) {
+   if (itoa(ctx->tmp_count++, &var_name, DECIMAL_BASE) != EXIT_FAILURE) {
       if (label) {
          T_StringInit(&(tmp_var->vals.str));
          CStringToT_String(var_name, &(tmp_var->vals.str));
          tmp_var->NID = NID_STRING;
       }
    }
-   if ((T_HTableInsert(id_table, var_name, tmp_var) == EXIT_FAILURE)
-      || (T_HTableExport(id_table, var_name, var) == HASH_NOT_FOUND))
+   if ((T_HTableInsert(ctx->id_table, var_name, tmp_var) == EXIT_FAILURE)
+      || (T_HTableExport(ctx->id_table, var_name, var) == HASH_NOT_FOUND))
    {
-      free(var_name);
-      free(tmp_var);
+      MemFree(var_name);
+      T_VarDelete(tmp_var);
+      POOL_DELETE(T_Var, tmp_var);
       return EXIT_FAILURE;
    }
 
-   free(var_name);
-   free(tmp_var);
+   MemFree(var_name);
+   T_VarDelete(tmp_var);
+   POOL_DELETE(T_Var, tmp_var);
 
    DEBUG_VAR_GEN_END(var);
    return EXIT_SUCCESS;
 }
 
-int CallBuiltin()
+int CallBuiltin(T_Context *ctx)
 {
-   if (strcmp(token.data, "input") == 0) {
-      lex_rc = GetToken(&token);
+   if (strcmp(ctx->token.data, "input") == 0) {
+      ctx->lex_rc = GetToken(ctx, &ctx->token);
       TOKEN_CHECK;
-      if (lex_rc != TOKEN_LBRACKET) {
+      if (ctx->lex_rc != TOKEN_LBRACKET) {
          errno = SYNTACTIC_ERROR;
          return EXIT_FAILURE;
       }
 
-      lex_rc = GetToken(&token);
+      ctx->lex_rc = GetToken(ctx, &ctx->token);
       TOKEN_CHECK;
-      if (lex_rc != TOKEN_RBRACKET) {
+      if (ctx->lex_rc != TOKEN_RBRACKET) {
          errno = SYNTACTIC_ERROR;
          return EXIT_FAILURE;
       }
 
-      if (T_HTableExport(id_table, "0ret", &write_var) == HASH_NOT_FOUND) {
+      if (T_HTableExport(ctx->id_table, "0ret", &ctx->write_var) == HASH_NOT_FOUND) {
          errno = INTERNAL_ERROR;
          return EXIT_FAILURE;
       }
-      GenerateInstruction(IID_INPUT, write_var, NULL, NULL);
+      GenerateInstruction(IID_INPUT, ctx->write_var, NULL, NULL);
       return EXIT_SUCCESS;
    }
 
-   else if (strcmp(token.data, "print") == 0) {
-      lex_rc = GetToken(&token);
+   else if (strcmp(ctx->token.data, "print") == 0) {
+      ctx->lex_rc = GetToken(ctx, &ctx->token);
       TOKEN_CHECK;
-      if (lex_rc != TOKEN_LBRACKET) {
+      if (ctx->lex_rc != TOKEN_LBRACKET) {
          errno = SYNTACTIC_ERROR;
          return EXIT_FAILURE;
       }
-      if (T_HTableExport(id_table, "0ret", &write_var) == HASH_NOT_FOUND) {
+      if (T_HTableExport(ctx->id_table, "0ret", &ctx->write_var) == HASH_NOT_FOUND) {
          errno = INTERNAL_ERROR;
          return EXIT_FAILURE;
       }
-      lex_rc = GetToken(&token);
+      ctx->lex_rc = GetToken(ctx, &ctx->token);
       TOKEN_CHECK;
-      CALL_CHECK(item());
+      CALL_CHECK(item(ctx));
 
-      GenerateInstruction(IID_PRINT, read_var, write_var, NULL);
-      CALL_CHECK(print_list());
+      GenerateInstruction(IID_PRINT, ctx->read_var, ctx->write_var, NULL);
+      CALL_CHECK(print_list(ctx));
       return EXIT_SUCCESS;
    }
 
-   else if (strcmp(token.data, "numeric") == 0) {
-      lex_rc = GetToken(&token);
+   else if (strcmp(ctx->token.data, "numeric") == 0) {
+      ctx->lex_rc = GetToken(ctx, &ctx->token);
       TOKEN_CHECK;
-      if (lex_rc != TOKEN_LBRACKET) {
+      if (ctx->lex_rc != TOKEN_LBRACKET) {
          errno = SYNTACTIC_ERROR;
          return EXIT_FAILURE;
       }
-      if (T_HTableExport(id_table, "0ret", &write_var) == HASH_NOT_FOUND) {
+      if (T_HTableExport(ctx->id_table, "0ret", &ctx->write_var) == HASH_NOT_FOUND) {
          errno = INTERNAL_ERROR;
          return EXIT_FAILURE;
       }
 
-      lex_rc = GetToken(&token);
+      ctx->lex_rc = GetToken(ctx, &ctx->token);
       TOKEN_CHECK;
-      CALL_CHECK(item());
+      CALL_CHECK(item(ctx));
 
-      GenerateInstruction(IID_NUMERIC, read_var, write_var, NULL);
+      GenerateInstruction(IID_NUMERIC, ctx->read_var, ctx->write_var, NULL);
 
-      lex_rc = GetToken(&token);
+      ctx->lex_rc = GetToken(ctx, &ctx->token);
       TOKEN_CHECK;
-      if (lex_rc != TOKEN_RBRACKET) {
+      if (ctx->lex_rc != TOKEN_RBRACKET) {
          errno = SYNTACTIC_ERROR;
          return EXIT_FAILURE;
       }
       return EXIT_SUCCESS;
    }
-   else if (strcmp(token.data, "typeOf") == 0) {
-      lex_rc = GetToken(&token);
+   else if (strcmp(ctx->token.data, "typeOf") == 0) {
+      ctx->lex_rc = GetToken(ctx, &ctx->token);
       TOKEN_CHECK;
-      if (lex_rc != TOKEN_LBRACKET) {
+      if (ctx->lex_rc != TOKEN_LBRACKET) {
          errno = SYNTACTIC_ERROR;
          return EXIT_FAILURE;
       }
-      if (T_HTableExport(id_table, "0ret", &write_var) == HASH_NOT_FOUND) {
+      if (T_HTableExport(ctx->id_table, "0ret", &ctx->write_var) == HASH_NOT_FOUND) {
          errno = INTERNAL_ERROR;
          return EXIT_FAILURE;
       }
 
-      lex_rc = GetToken(&token);
+      ctx->lex_rc = GetToken(ctx, &ctx->token);
       TOKEN_CHECK;
-      CALL_CHECK(item());
+      CALL_CHECK(item(ctx));
 
-      GenerateInstruction(IID_TYPEOF, read_var, write_var, NULL);
+      GenerateInstruction(IID_TYPEOF, ctx->read_var, ctx->write_var, NULL);
 
-      lex_rc = GetToken(&token);
+      ctx->lex_rc = GetToken(ctx, &ctx->token);
       TOKEN_CHECK;
-      if (lex_rc != TOKEN_RBRACKET) {
+      if (ctx->lex_rc != TOKEN_RBRACKET) {
          errno = SYNTACTIC_ERROR;
          return EXIT_FAILURE;
       }
 
       return EXIT_SUCCESS;
    }
-   else if (strcmp(token.data, "len") == 0) {
-      lex_rc = GetToken(&token);
+   else if (strcmp(ctx->token.data, "len") == 0) {
+      ctx->lex_rc = GetToken(ctx, &ctx->token);
       TOKEN_CHECK;
-      if (lex_rc != TOKEN_LBRACKET) {
+      if (ctx->lex_rc != TOKEN_LBRACKET) {
          errno = SYNTACTIC_ERROR;
          return EXIT_FAILURE;
       }
-      if (T_HTableExport(id_table, "0ret", &write_var) == HASH_NOT_FOUND) {
+      if (T_HTableExport(ctx->id_table, "0ret", &ctx->write_var) == HASH_NOT_FOUND) {
          errno = INTERNAL_ERROR;
          return EXIT_FAILURE;
       }
 
-      lex_rc = GetToken(&token);
+      ctx->lex_rc = GetToken(ctx, &ctx->token);
       TOKEN_CHECK;
-      CALL_CHECK(item());
+      CALL_CHECK(item(ctx));
 
-      GenerateInstruction(IID_LEN, read_var, write_var, NULL);
+      GenerateInstruction(IID_LEN, ctx->read_var, ctx->write_var, NULL);
 
-      lex_rc = GetToken(&token);
+      ctx->lex_rc = GetToken(ctx, &ctx->token);
       TOKEN_CHECK;
-      if (lex_rc != TOKEN_RBRACKET) {
+      if (ctx->lex_rc != TOKEN_RBRACKET) {
          errno = SYNTACTIC_ERROR;
          return EXIT_FAILURE;
       }
 
       return EXIT_SUCCESS;
    }
-   else if (strcmp(token.data, "find") == 0) {
+   else if (strcmp(ctx->token.data, "find") == 0) {
       // TODO
    }
-   else if (strcmp(token.data, "sort") == 0) {
-      lex_rc = GetToken(&token);
+   else if (strcmp(ctx->token.data, "sort") == 0) {
+      ctx->lex_rc = GetToken(ctx, &ctx->token);
       TOKEN_CHECK;
-      if (lex_rc != TOKEN_LBRACKET) {
+      if (ctx->lex_rc != TOKEN_LBRACKET) {
          errno = SYNTACTIC_ERROR;
          return EXIT_FAILURE;
       }
-      if (T_HTableExport(id_table, "0ret", &write_var) == HASH_NOT_FOUND) {
+      if (T_HTableExport(ctx->id_table, "0ret", &ctx->write_var) == HASH_NOT_FOUND) {
          errno = INTERNAL_ERROR;
          return EXIT_FAILURE;
       }
 
-      lex_rc = GetToken(&token);
+      ctx->lex_rc = GetToken(ctx, &ctx->token);
       TOKEN_CHECK;
-      CALL_CHECK(item());
+      CALL_CHECK(item(ctx));
 
-      GenerateInstruction(IID_SORT, read_var, write_var, NULL);
+      GenerateInstruction(IID_SORT, ctx->read_var, ctx->write_var, NULL);
 
-      lex_rc = GetToken(&token);
+      ctx->lex_rc = GetToken(ctx, &ctx->token);
       TOKEN_CHECK;
-      if (lex_rc != TOKEN_RBRACKET) {
+      if (ctx->lex_rc != TOKEN_RBRACKET) {
          errno = SYNTACTIC_ERROR;
          return EXIT_FAILURE;
       }
@@ -346,23 +353,23 @@ int CallBuiltin()
    return EXIT_SUCCESS;
 }
 
-int CallFunction()
+int CallFunction(T_Context *ctx)
 {
    // Saves a name of called function, currently located in token
    T_String f_name;
    T_StringInit(&f_name);
-   T_StringCopy(&f_name, &token);
+   T_StringCopy(&f_name, &ctx->token);
 
    // Opening bracket must follow
-   lex_rc = GetToken(&token);
+   ctx->lex_rc = GetToken(ctx, &ctx->token);
    TOKEN_CHECK;
-   if (lex_rc == TOKEN_LBRACKET) {
-      T_HashTable *tmp_table = malloc(sizeof(T_HashTable));
-      T_Var *f_var = malloc(sizeof(T_Var));
+   if (ctx->lex_rc == TOKEN_LBRACKET) {
+      T_HashTable *tmp_table = MemAlloc(sizeof(T_HashTable));
+      T_Var *f_var = POOL_NEW(T_Var);
 
       if (tmp_table == NULL || f_var == NULL) {
-         free(tmp_table);
-         free(f_var);
+         MemFree(tmp_table);
+         POOL_DELETE(T_Var, f_var);
          errno = INTERNAL_ERROR;
          return EXIT_FAILURE;
       }
@@ -371,10 +378,10 @@ int CallFunction()
       T_VarInit(f_var);
 
       // Adds current id_table to table list and change its pointer
-      T_IdListAppend(table_list, id_table);
-      id_table = tmp_table;
+      T_IdListAppend(ctx->table_list, ctx->id_table);
+      ctx->id_table = tmp_table;
 
-      T_Var *var = malloc(sizeof(T_Var));
+      T_Var *var = POOL_NEW(T_Var);
       PTR_CHECK(var);
 
       T_VarInit(var);
@@ -382,25 +389,25 @@ int CallFunction()
 
       char *reserved[] = {"as", "def", "directive", "export", "from", "import", "launch", "load", "macro", "input", "print", "numeric", "typeOf", "len", ""};
 
-      T_HTableInit(id_table);
+      T_HTableInit(ctx->id_table);
 
       for (int i = 0; strcmp(reserved[i], "") != 0; i++)
-         T_HTableInsert(id_table, reserved[i], var);
+         T_HTableInsert(ctx->id_table, reserved[i], var);
 
-      free(var);
+      POOL_DELETE(T_Var, var);
 
       // Gets all function parameters into hash table
-      if (write_var->vals.args.size > 0) {
-         lex_rc = GetToken(&token);
+      if (ctx->write_var->vals.args != NULL && ctx->write_var->vals.args->size > 0) {
+         ctx->lex_rc = GetToken(ctx, &ctx->token);
          TOKEN_CHECK;
-         CALL_CHECK(item());
-         CALL_CHECK(T_HTableInsert(id_table, write_var->vals.args.first->data.data, read_var));
-         CALL_CHECK(it_list(write_var->vals.args.first->next));
+         CALL_CHECK(item(ctx));
+         CALL_CHECK(T_HTableInsert(ctx->id_table, ctx->write_var->vals.args->first->data.data, ctx->read_var));
+         CALL_CHECK(it_list(ctx, ctx->write_var->vals.args->first->next));
       }
       else {
-         lex_rc = GetToken(&token);
+         ctx->lex_rc = GetToken(ctx, &ctx->token);
          TOKEN_CHECK;
-         if (lex_rc != TOKEN_RBRACKET) {
+         if (ctx->lex_rc != TOKEN_RBRACKET) {
             errno = SYNTACTIC_ERROR;
             return EXIT_FAILURE;
          }
@@ -411,11 +418,11 @@ int CallFunction()
       GenerateInstruction(IID_JUMP, f_var, NULL, NULL);
 
       // Generates a lable as a return point
-      GenerateVariable(TRUE, &write_var);
-      GenerateInstruction(IID_LABEL, write_var, NULL, NULL);
-      T_LabelListAppend(cal_list, inst_list->last);
+      GenerateVariable(ctx, TRUE, &ctx->write_var);
+      GenerateInstruction(IID_LABEL, ctx->write_var, NULL, NULL);
+      T_LabelListAppend(ctx->cal_list, ctx->inst_list->last);
 
-      free(f_var);
+      POOL_DELETE(T_Var, f_var);
 
       return EXIT_SUCCESS;
    }
@@ -424,45 +431,45 @@ int CallFunction()
    return EXIT_FAILURE;
 }
 
-int Synan()
+int Synan(T_Context *ctx)
 {
    DEBUG_SYNAN;
 
-   lex_rc = GetToken(&token);
+   ctx->lex_rc = GetToken(ctx, &ctx->token);
    TOKEN_CHECK;
-   if (lex_rc == TOKEN_EOF) {
+   if (ctx->lex_rc == TOKEN_EOF) {
       DEBUG_SYNAN_END;
       return EXIT_SUCCESS;
    }
    else
-      CALL_CHECK(stat(MODE_OUTSIDE));
+      CALL_CHECK(stat(ctx, MODE_OUTSIDE));
 
    DEBUG_SYNAN_END;
-   return Synan();
+   return Synan(ctx);
 
    errno = SYNTACTIC_ERROR;
    return EXIT_FAILURE;
 }
 
-int stat(int mode)
+static int stat(T_Context *ctx, int mode)
 {
    DEBUG_STAT;
-   if (lex_rc == TOKEN_EOL)
+   if (ctx->lex_rc == TOKEN_EOL)
       return EXIT_SUCCESS;
 
-   if (lex_rc == TOKEN_IDENTIFICATOR) {
-      if (T_HTableSearch(kw_table, token.data) != NULL) { // Keyword
+   if (ctx->lex_rc == TOKEN_IDENTIFICATOR) {
+      if (T_HTableSearch(ctx->kw_table, ctx->token.data) != NULL) { // Keyword
          DEBUG_STAT_KEYWORD;
-         return keyword(mode);
+         return keyword(ctx, mode);
       }
 
-      if (T_HTableSearch(builtin_table, token.data) != NULL)
-         return CallBuiltin();
+      if (T_HTableSearch(ctx->builtin_table, ctx->token.data) != NULL)
+         return CallBuiltin(ctx);
 
-      int htable_rc = T_HTableExport(id_table, token.data, &write_var);
-      if (htable_rc == HASH_FOUND && write_var->NID == NID_FUNCTION) { // Known function
+      int htable_rc = T_HTableExport(ctx->id_table, ctx->token.data, &ctx->write_var);
+      if (htable_rc == HASH_FOUND && ctx->write_var->NID == NID_FUNCTION) { // Known function
          DEBUG_STAT_FUNCTION;
-         CALL_CHECK(CallFunction());
+         CALL_CHECK(CallFunction(ctx));
          DEBUG_STAT_END;
          return EXIT_SUCCESS;
       }
@@ -470,32 +477,32 @@ int stat(int mode)
          DEBUG_STAT_VAR;
          if (htable_rc == HASH_NOT_FOUND) {
             // Variable doesn't exist, create it as undefined and save into table
-            T_Var *tmp_var = malloc(sizeof(T_Var));
+            T_Var *tmp_var = POOL_NEW(T_Var);
             PTR_CHECK(tmp_var);
 
             T_VarInit(tmp_var);
 
-            if (T_HTableInsert(id_table, token.data, tmp_var) == EXIT_FAILURE) {
-               free(tmp_var);
+            if (T_HTableInsert(ctx->id_table, ctx->token.data, tmp_var) == EXIT_FAILURE) {
+               POOL_DELETE(T_Var, tmp_var);
                return EXIT_FAILURE;
             }
-            free(tmp_var);
+            POOL_DELETE(T_Var, tmp_var);
          }
 
          // Assign write_var pointer to newly created variable
-         if (T_HTableExport(id_table, token.data, &write_var) == HASH_NOT_FOUND) {
+         if (T_HTableExport(ctx->id_table, ctx->token.data, &ctx->write_var) == HASH_NOT_FOUND) {
             errno = INTERNAL_ERROR;
             return EXIT_FAILURE;
          }
 
          // Next expected token is assignment character
-         lex_rc = GetToken(&token);
+         ctx->lex_rc = GetToken(ctx, &ctx->token);
          TOKEN_CHECK;
-         if (lex_rc == TOKEN_ASSIGN) {
-            CALL_CHECK(expr());
+         if (ctx->lex_rc == TOKEN_ASSIGN) {
+            CALL_CHECK(expr(ctx));
 
             // write_var points to variable from the table, read_var points to the expression result
-            GenerateInstruction(IID_COPY, write_var, read_var, NULL);
+            GenerateInstruction(IID_COPY, ctx->write_var, ctx->read_var, NULL);
 
             DEBUG_STAT_END;
             return EXIT_SUCCESS;
@@ -507,58 +514,58 @@ int stat(int mode)
    return EXIT_FAILURE;
 }
 
-int keyword(int mode)
+int keyword(T_Context *ctx, int mode)
 {
    DEBUG_KW;
 
-   if (lex_rc == TOKEN_IDENTIFICATOR) {
-      if (strcmp(token.data,"if") == 0 ) {
+   if (ctx->lex_rc == TOKEN_IDENTIFICATOR) {
+      if (strcmp(ctx->token.data,"if") == 0 ) {
          DEBUG_KW_IF;
 
-         CALL_CHECK(expr());
+         CALL_CHECK(expr(ctx));
 
-         GenerateVariable(TRUE, &write_var);
-         GenerateInstruction(IID_BRAFAL, read_var, write_var, NULL);
+         GenerateVariable(ctx, TRUE, &ctx->write_var);
+         GenerateInstruction(IID_BRAFAL, ctx->read_var, ctx->write_var, NULL);
 
-         CALL_CHECK(if_state(MODE_OUTSIDE, write_var));
+         CALL_CHECK(if_state(ctx, MODE_OUTSIDE, ctx->write_var));
 
          DEBUG_KW_END;
          return EXIT_SUCCESS;
       }
 
-      else if (strcmp(token.data,"while") == 0 ) {
+      else if (strcmp(ctx->token.data,"while") == 0 ) {
          DEBUG_KW_WHILE;
 
          T_Var *start_lbl;
-         GenerateVariable(TRUE, &start_lbl);
+         GenerateVariable(ctx, TRUE, &start_lbl);
          GenerateInstruction(IID_LABEL, start_lbl, NULL, NULL);
-         T_LabelListAppend(lbl_list, inst_list->last);
+         T_LabelListAppend(ctx->lbl_list, ctx->inst_list->last);
 
-         CALL_CHECK(expr());
+         CALL_CHECK(expr(ctx));
 
-         GenerateVariable(TRUE, &write_var);
-         GenerateInstruction(IID_BRAFAL, read_var, write_var, NULL);
+         GenerateVariable(ctx, TRUE, &ctx->write_var);
+         GenerateInstruction(IID_BRAFAL, ctx->read_var, ctx->write_var, NULL);
 
-         CALL_CHECK(while_state(start_lbl, write_var));
+         CALL_CHECK(while_state(ctx, start_lbl, ctx->write_var));
 
          DEBUG_KW_END;
          return EXIT_SUCCESS;
       }
 
-      else if (strcmp(token.data,"function") == 0 && (mode == MODE_OUTSIDE)) {
+      else if (strcmp(ctx->token.data,"function") == 0 && (mode == MODE_OUTSIDE)) {
          DEBUG_KW_FUNCTION;
 
-         lex_rc = GetToken(&token);
+         ctx->lex_rc = GetToken(ctx, &ctx->token);
 //         TOKEN_CHECK;
-//         if (lex_rc == TOKEN_IDENTIFICATOR) {
-//            lex_rc = GetToken(&token);
+//         if (ctx->lex_rc == TOKEN_IDENTIFICATOR) {
+//            ctx->lex_rc = GetToken(ctx, &ctx->token);
 //            TOKEN_CHECK;
-//            if (lex_rc == TOKEN_LBRACKET) {
+//            if (ctx->lex_rc == TOKEN_LBRACKET) {
 //
-//               f_item();
+//               f_item(ctx);
 //               CALL_CHECK(f_());
 //
-//               lex_rc = GetToken(&token);
+//               ctx->lex_rc = GetToken(ctx, &ctx->token);
 //               TOKEN_CHECK;
 //
 //               DEBUG_KW_END;
@@ -572,49 +579,49 @@ int keyword(int mode)
    return EXIT_FAILURE;
 }
 
-int while_state(T_Var *start_lbl, T_Var *end_lbl)
+int while_state(T_Context *ctx, T_Var *start_lbl, T_Var *end_lbl)
 {
    DEBUG_WHILE;
 
-   lex_rc = GetToken(&token);
+   ctx->lex_rc = GetToken(ctx, &ctx->token);
    TOKEN_CHECK;
-   if (lex_rc == TOKEN_IDENTIFICATOR) {
-      if (strcmp(token.data, "end") == 0) {
+   if (ctx->lex_rc == TOKEN_IDENTIFICATOR) {
+      if (strcmp(ctx->token.data, "end") == 0) {
          GenerateInstruction(IID_JUMP, start_lbl, NULL, NULL);
          GenerateInstruction(IID_LABEL, end_lbl, NULL, NULL);
-         T_LabelListAppend(lbl_list, inst_list->last);
+         T_LabelListAppend(ctx->lbl_list, ctx->inst_list->last);
 
          return EXIT_SUCCESS;
       }
    }
 
-   CALL_CHECK(stat(MODE_INSIDE));
-   CALL_CHECK(while_state(start_lbl, end_lbl));
+   CALL_CHECK(stat(ctx, MODE_INSIDE));
+   CALL_CHECK(while_state(ctx, start_lbl, end_lbl));
 
    DEBUG_WHILE_END;
 
    return EXIT_SUCCESS;
 }
 
-int f_item()
+int f_item(T_Context *ctx)
 {
    if (TOKEN_IDENTIFICATOR)
-      read_var->vals.args.first->data = token;
+      ctx->read_var->vals.args->first->data = ctx->token;
    
    return EXIT_SUCCESS;
 }
 
-int item()
+int item(T_Context *ctx)
 {
    DEBUG_ITEM;
 
    double tmp;
-   switch (lex_rc) {
+   switch (ctx->lex_rc) {
    case TOKEN_STRING:
       DEBUG_ITEM_STR;
 
-      CALL_CHECK(GenerateVariable(FALSE, &read_var));
-      T_StringToT_Var(&token, read_var);
+      CALL_CHECK(GenerateVariable(ctx, FALSE, &ctx->read_var));
+      T_StringToT_Var(&ctx->token, ctx->read_var);
 
       DEBUG_ITEM_END;
       return EXIT_SUCCESS;
@@ -622,45 +629,45 @@ int item()
    case TOKEN_NUMBER:
       DEBUG_ITEM_NUM;
 
-      CALL_CHECK(GenerateVariable(FALSE, &read_var));
-      tmp = strtod(token.data, NULL);
-      CDoubleToT_Var(tmp, read_var);
+      CALL_CHECK(GenerateVariable(ctx, FALSE, &ctx->read_var));
+      tmp = strtod(ctx->token.data, NULL);
+      CDoubleToT_Var(tmp, ctx->read_var);
 
       DEBUG_ITEM_END;
       return EXIT_SUCCESS;
    break;
 
    case TOKEN_IDENTIFICATOR:
-      if (strcmp(token.data, "true") == 0) {
+      if (strcmp(ctx->token.data, "true") == 0) {
          DEBUG_ITEM_TRUE;
 
-         CALL_CHECK(GenerateVariable(FALSE, &read_var));
-         read_var->NID = NID_BOOL;
-         read_var->vals.b_val = 1;
+         CALL_CHECK(GenerateVariable(ctx, FALSE, &ctx->read_var));
+         ctx->read_var->NID = NID_BOOL;
+         ctx->read_var->vals.b_val = 1;
 
          DEBUG_ITEM_END;
          return EXIT_SUCCESS;
       }
-      else if (strcmp(token.data, "false") == 0) {
+      else if (strcmp(ctx->token.data, "false") == 0) {
          DEBUG_ITEM_FALSE;
 
-         CALL_CHECK(GenerateVariable(FALSE, &read_var));
-         read_var->NID = NID_BOOL;
-         read_var->vals.b_val = 0;
+         CALL_CHECK(GenerateVariable(ctx, FALSE, &ctx->read_var));
+         ctx->read_var->NID = NID_BOOL;
+         ctx->read_var->vals.b_val = 0;
 
          DEBUG_ITEM_END;
          return EXIT_SUCCESS;
       }
-      else if (strcmp(token.data, "nil") == 0) {
+      else if (strcmp(ctx->token.data, "nil") == 0) {
          DEBUG_ITEM_NIL;
 
-         CALL_CHECK(GenerateVariable(FALSE, &read_var));
-         read_var->NID = NID_NIL;
+         CALL_CHECK(GenerateVariable(ctx, FALSE, &ctx->read_var));
+         ctx->read_var->NID = NID_NIL;
 
          DEBUG_ITEM_END;
          return EXIT_SUCCESS;
       }
-      else if (T_HTableExport(id_table, token.data, &read_var) == HASH_FOUND) {
+      else if (T_HTableExport(ctx->id_table, ctx->token.data, &ctx->read_var) == HASH_FOUND) {
          DEBUG_ITEM_ID;
          return EXIT_SUCCESS;
       }
@@ -671,32 +678,32 @@ int item()
    return EXIT_FAILURE;
 }
 
-int it_list(T_ArgItem *item_arg)
+int it_list(T_Context *ctx, T_ArgItem *item_arg)
 {
    DEBUG_IT_LIST;
 
-   lex_rc = GetToken(&token);
+   ctx->lex_rc = GetToken(ctx, &ctx->token);
    TOKEN_CHECK;
 
-   if (lex_rc == TOKEN_RBRACKET) {
+   if (ctx->lex_rc == TOKEN_RBRACKET) {
       DEBUG_IT_LIST_END;
       return EXIT_SUCCESS;
    }
 
-   else if (lex_rc == TOKEN_COMMA) {
-      lex_rc = GetToken(&token);
+   else if (ctx->lex_rc == TOKEN_COMMA) {
+      ctx->lex_rc = GetToken(ctx, &ctx->token);
       TOKEN_CHECK;
-      CALL_CHECK(item());
+      CALL_CHECK(item(ctx));
 
       if (item_arg == NULL) {
          errno = SYNTACTIC_ERROR;
          return EXIT_FAILURE;
       }
-      CALL_CHECK(T_HTableInsert(id_table, item_arg->data.data, read_var));
-      CALL_CHECK(it_list(item_arg->next));
+      CALL_CHECK(T_HTableInsert(ctx->id_table, item_arg->data.data, ctx->read_var));
+      CALL_CHECK(it_list(ctx, item_arg->next));
    }
 
-   else if (lex_rc == TOKEN_BROKEN || lex_rc == TOKEN_PROBLEM)
+   else if (ctx->lex_rc == TOKEN_BROKEN || ctx->lex_rc == TOKEN_PROBLEM)
       return EXIT_FAILURE;
 
    else {
@@ -707,28 +714,28 @@ int it_list(T_ArgItem *item_arg)
    return EXIT_SUCCESS;
 }
 
-int print_list()
+int print_list(T_Context *ctx)
 {
-   lex_rc = GetToken(&token);
+   ctx->lex_rc = GetToken(ctx, &ctx->token);
    TOKEN_CHECK;
 
-   if (lex_rc == TOKEN_RBRACKET)
+   if (ctx->lex_rc == TOKEN_RBRACKET)
       return EXIT_SUCCESS;
 
-   else if (lex_rc == TOKEN_COMMA) {
-      lex_rc = GetToken(&token);
+   else if (ctx->lex_rc == TOKEN_COMMA) {
+      ctx->lex_rc = GetToken(ctx, &ctx->token);
       TOKEN_CHECK;
-      CALL_CHECK(item());
+      CALL_CHECK(item(ctx));
 
-      if (T_HTableExport(id_table, "0ret", &write_var) == HASH_NOT_FOUND) {
+      if (T_HTableExport(ctx->id_table, "0ret", &ctx->write_var) == HASH_NOT_FOUND) {
          errno = INTERNAL_ERROR;
          return EXIT_FAILURE;
       }
-      GenerateInstruction(IID_PRINT, read_var, write_var, NULL);
-      CALL_CHECK(print_list());
+      GenerateInstruction(IID_PRINT, ctx->read_var, ctx->write_var, NULL);
+      CALL_CHECK(print_list(ctx));
    }
 
-   else if (lex_rc == TOKEN_BROKEN || lex_rc == TOKEN_PROBLEM)
+   else if (ctx->lex_rc == TOKEN_BROKEN || ctx->lex_rc == TOKEN_PROBLEM)
       return EXIT_FAILURE;
 
    else {
@@ -739,39 +746,39 @@ int print_list()
    return EXIT_SUCCESS;
 }
 
-int if_state(int mode, T_Var *jmp)
+int if_state(T_Context *ctx, int mode, T_Var *jmp)
 {
    DEBUG_IF;
 
-   lex_rc = GetToken(&token);
+   ctx->lex_rc = GetToken(ctx, &ctx->token);
    TOKEN_CHECK;
-   if (lex_rc == TOKEN_IDENTIFICATOR) {
-      if (mode == MODE_OUTSIDE && strcmp(token.data, "else") == 0) {
+   if (ctx->lex_rc == TOKEN_IDENTIFICATOR) {
+      if (mode == MODE_OUTSIDE && strcmp(ctx->token.data, "else") == 0) {
          DEBUG_IF_ELSE;
          // Expression is true -- jump behind else
-         GenerateVariable(TRUE, &write_var);
-         GenerateInstruction(IID_JUMP, write_var, NULL, NULL);
+         GenerateVariable(ctx, TRUE, &ctx->write_var);
+         GenerateInstruction(IID_JUMP, ctx->write_var, NULL, NULL);
 
          // Expression is false -- else follows
          GenerateInstruction(IID_LABEL, jmp, NULL, NULL);
-         T_LabelListAppend(lbl_list, inst_list->last);
+         T_LabelListAppend(ctx->lbl_list, ctx->inst_list->last);
 
-         return if_state(MODE_INSIDE, write_var);
+         return if_state(ctx, MODE_INSIDE, ctx->write_var);
       }
 
-      else if (strcmp(token.data, "end") == 0) {
+      else if (strcmp(ctx->token.data, "end") == 0) {
          DEBUG_IF_END;
          // Once end is found, places its label
          GenerateInstruction(IID_LABEL, jmp, NULL, NULL);
-         T_LabelListAppend(lbl_list, inst_list->last);
+         T_LabelListAppend(ctx->lbl_list, ctx->inst_list->last);
 
          return EXIT_SUCCESS;
       }
    }
 
-   CALL_CHECK(stat(MODE_INSIDE));
+   CALL_CHECK(stat(ctx, MODE_INSIDE));
 
-   CALL_CHECK(if_state(mode, jmp));
+   CALL_CHECK(if_state(ctx, mode, jmp));
 
    DEBUG_IF_END;
    return EXIT_SUCCESS;
@@ -786,29 +793,124 @@ typedef struct Exlist{
    T_Var *value;
    int operace;
    int zavorka;
+   int literal; // hodnota je znama uz pri preklade (literal alebo zlozena konstanta)
    struct Exlist *next;
 } Expr_list;
 
+/* Zlozenie konstant: ak su oba operandy operacie pom->operace literaly,
+   vypocita vysledok uz pri preklade a vrati ho v *var ako novu konstantu.
+   Inac (a aj vtedy, ked by operacia skoncila chybou za behu, napr. delenie
+   nulou) vrati *var = NULL a instrukcia sa generuje normalne.
+*/
+static int FoldConstant(T_Context *ctx, Expr_list *pom, T_Var **var)
+{
+   T_Var *a = pom->value;
+   T_Var *b = pom->next->value;
+   *var = NULL;
+
+   if (!pom->literal || !pom->next->literal)
+      return EXIT_SUCCESS;
+
+   // Cisla
+   if (a->NID == NID_NUMBER && b->NID == NID_NUMBER) {
+      double x = NUM_VAL(a);
+      double y = NUM_VAL(b);
+      double d_val = 0.0;
+      int b_val = -1;
+
+      switch (pom->operace) {
+      case TOKEN_DSTAR   : {
+         // pow() moze nastavit errno (ERANGE), preklad ho pouziva na kod chyby
+         int saved = errno;
+         d_val = pow(x, y);
+         errno = saved;
+         break;
+      }
+      case TOKEN_STAR    : d_val = x * y; break;
+      case TOKEN_SLASH   : if (y == 0.0) return EXIT_SUCCESS; d_val = x / y; break;
+      case TOKEN_PLUS    : d_val = x + y; break;
+      case TOKEN_MINUS   : d_val = x - y; break;
+      case TOKEN_EQUAL   : b_val = (x == y); break;
+      case TOKEN_UNEQUAL : b_val = (x != y); break;
+      case TOKEN_BEQUAL  : b_val = (x >= y); break;
+      case TOKEN_SMEQUAL : b_val = (x <= y); break;
+      case TOKEN_SMALLER : b_val = (x < y); break;
+      case TOKEN_BIGGER  : b_val = (x > y); break;
+      default : return EXIT_SUCCESS;
+      }
+
+      CALL_CHECK(GenerateVariable(ctx, FALSE, var));
+      if (b_val < 0)
+         CDoubleToT_Var(d_val, *var);
+      else {
+         (*var)->NID = NID_BOOL;
+         (*var)->vals.b_val = b_val;
+      }
+      return EXIT_SUCCESS;
+   }
+
+   // Retazce: konkatenacia a relacie
+   if (a->NID == NID_STRING && b->NID == NID_STRING) {
+      int cmp = strcmp(a->vals.str.data, b->vals.str.data);
+      int b_val;
+
+      switch (pom->operace) {
+      case TOKEN_PLUS :
+         CALL_CHECK(GenerateVariable(ctx, FALSE, var));
+         CALL_CHECK(T_StringCopy(&((*var)->vals.str), &(a->vals.str)));
+         CALL_CHECK(T_StringCat(&((*var)->vals.str), &(b->vals.str)));
+         (*var)->NID = NID_STRING;
+         return EXIT_SUCCESS;
+      case TOKEN_EQUAL   : b_val = (cmp == 0); break;
+      case TOKEN_UNEQUAL : b_val = (cmp != 0); break;
+      case TOKEN_BEQUAL  : b_val = (cmp >= 0); break;
+      case TOKEN_SMEQUAL : b_val = (cmp <= 0); break;
+      case TOKEN_SMALLER : b_val = (cmp < 0); break;
+      case TOKEN_BIGGER  : b_val = (cmp > 0); break;
+      default : return EXIT_SUCCESS;
+      }
+
+      CALL_CHECK(GenerateVariable(ctx, FALSE, var));
+      (*var)->NID = NID_BOOL;
+      (*var)->vals.b_val = b_val;
+      return EXIT_SUCCESS;
+   }
+
+   // Mocnina retazca, prilis dlhe vysledky sa nechaju na interpret
+   if (a->NID == NID_STRING && b->NID == NID_NUMBER && pom->operace == TOKEN_STAR) {
+      int mocn = (int)NUM_VAL(b);
+      if (mocn < 0 || (double)STRING_LENGTH(&a->vals.str) * mocn > FOLD_STRING_MAX)
+         return EXIT_SUCCESS;
+
+      CALL_CHECK(GenerateVariable(ctx, FALSE, var));
+      CALL_CHECK(T_StringInit(&((*var)->vals.str)));
+      for ( ; mocn > 0; mocn--)
+         CALL_CHECK(T_StringCat(&((*var)->vals.str), &(a->vals.str)));
+      (*var)->NID = NID_STRING;
+   }
+
+   return EXIT_SUCCESS;
+}
+
 // Vyber retezce : zpracovani  [ num/id/() :  num/id/() ] EOL
 // String / id je jiz nacteny
-int expr_string(T_Var **num1 , T_Var **num2)
+int expr_string(T_Context *ctx, T_Var **num1 , T_Var **num2)
 {
 // [ -------cekam cislo nebo :
-   lex_rc = GetToken(&token);
+   ctx->lex_rc = GetToken(ctx, &ctx->token);
    TOKEN_CHECK;
 
-   if ((lex_rc == NID_NUMBER) || (lex_rc == TOKEN_IDENTIFICATOR)) {
+   if ((ctx->lex_rc == NID_NUMBER) || (ctx->lex_rc == TOKEN_IDENTIFICATOR)) {
       //1. NUMBER
-      if (lex_rc == NID_NUMBER) {
-         *num1 = malloc(sizeof(T_Var));
-         PTR_CHECK(*num1);
-         CDoubleToT_Var(atof(token.data), *num1);
-         if (debug)printf("%f" , (*num1)->vals.d_val);
+      if (ctx->lex_rc == NID_NUMBER) {
+         CALL_CHECK(GenerateVariable(ctx, FALSE, num1));
+         CDoubleToT_Var(atof(ctx->token.data), *num1);
+         if (debug)printf("%f" , NUM_VAL(*num1));
       }
 
       //2. IDENTIFIKATOR
-      if (lex_rc == TOKEN_IDENTIFICATOR) {
-         if (T_HTableExport(id_table, token.data, num1) == HASH_NOT_FOUND) {
+      if (ctx->lex_rc == TOKEN_IDENTIFICATOR) {
+         if (T_HTableExport(ctx->id_table, ctx->token.data, num1) == HASH_NOT_FOUND) {
             if (errno == 0) errno = SYNTACTIC_ERROR;
             if (debug)printf("non exist id");
             return EXIT_FAILURE;
@@ -817,10 +919,10 @@ int expr_string(T_Var **num1 , T_Var **num2)
 
       //------------------------------------------------------------------
       //COMA PO CISLE NEBO ID
-      lex_rc = GetToken(&token);
+      ctx->lex_rc = GetToken(ctx, &ctx->token);
       TOKEN_CHECK;
-      if (debug) printf("-----%s----", token.data);
-      if (lex_rc != TOKEN_COLUMN) {
+      if (debug) printf("-----%s----", ctx->token.data);
+      if (ctx->lex_rc != TOKEN_COLUMN) {
          if (errno == 0) errno = SYNTACTIC_ERROR;
          if (debug)printf("cekam colum1");
          return EXIT_FAILURE;
@@ -828,50 +930,49 @@ int expr_string(T_Var **num1 , T_Var **num2)
    }
 
    //colum PO HRANATE ZAVORCE
-   else if (lex_rc == TOKEN_COLUMN) { *num1 = NULL; if (debug) printf("prazdno"); }
+   else if (ctx->lex_rc == TOKEN_COLUMN) { *num1 = NULL; if (debug) printf("prazdno"); }
    else {
       if (errno == 0) errno = SYNTACTIC_ERROR;
       if (debug) printf("cekam colum2");
       return EXIT_FAILURE;
    }
 //------------------------------------------------------------------
-   lex_rc = GetToken(&token);
+   ctx->lex_rc = GetToken(ctx, &ctx->token);
    TOKEN_CHECK;
-   if ((lex_rc == NID_NUMBER) || (lex_rc == TOKEN_IDENTIFICATOR)) {
+   if ((ctx->lex_rc == NID_NUMBER) || (ctx->lex_rc == TOKEN_IDENTIFICATOR)) {
       //1. NUMBER 2
-      if (lex_rc == NID_NUMBER) {
-         *num2 = malloc(sizeof(T_Var));
-         PTR_CHECK(*num2);
-         CDoubleToT_Var(atof(token.data), *num2);
-         if (debug) printf("%f" , (*num2)->vals.d_val);
+      if (ctx->lex_rc == NID_NUMBER) {
+         CALL_CHECK(GenerateVariable(ctx, FALSE, num2));
+         CDoubleToT_Var(atof(ctx->token.data), *num2);
+         if (debug) printf("%f" , NUM_VAL(*num2));
       }
      //2. IDENTIFIKATOR 2
-      if (lex_rc == TOKEN_IDENTIFICATOR) {
-         if (T_HTableExport(id_table, token.data, &(*num2)) == HASH_NOT_FOUND) {
+      if (ctx->lex_rc == TOKEN_IDENTIFICATOR) {
+         if (T_HTableExport(ctx->id_table, ctx->token.data, &(*num2)) == HASH_NOT_FOUND) {
             if (errno == 0) errno = SYNTACTIC_ERROR;
             if (debug) printf("non exist id");
             return EXIT_FAILURE;}
      }
      // hranata po cisle nebo id
-      lex_rc = GetToken(&token);
+      ctx->lex_rc = GetToken(ctx, &ctx->token);
       TOKEN_CHECK;
-      if (lex_rc != TOKEN_RSBRACKET) {
+      if (ctx->lex_rc != TOKEN_RSBRACKET) {
          if (errno == 0) errno = SYNTACTIC_ERROR;
          if (debug) printf("cekam hranata");
          return EXIT_FAILURE;
       }
    }
-   else if (lex_rc == TOKEN_RSBRACKET) {*num2 = NULL; if (debug) printf("prazdno2");}
+   else if (ctx->lex_rc == TOKEN_RSBRACKET) {*num2 = NULL; if (debug) printf("prazdno2");}
       else {
          if (errno == 0) errno = SYNTACTIC_ERROR;
          if (debug) printf("cekam hranata");
          return EXIT_FAILURE;
       }
 
-   lex_rc=GetToken(&token);
+   ctx->lex_rc=GetToken(ctx, &ctx->token);
 
-   if ((lex_rc == TOKEN_EOL) || (lex_rc == TOKEN_EOF)) { 
-       if (debug) printf(" %d ", lex_rc);
+   if ((ctx->lex_rc == TOKEN_EOL) || (ctx->lex_rc == TOKEN_EOF)) { 
+       if (debug) printf(" %d ", ctx->lex_rc);
    }
    else {
      if (errno == 0) errno = SYNTACTIC_ERROR;
@@ -882,33 +983,34 @@ int expr_string(T_Var **num1 , T_Var **num2)
 }
 
 // generator listu z tokenu - vlastnost operace,zavorek,hodnoty/NID
-int gener_list(Expr_list **L)
+int gener_list(T_Context *ctx, Expr_list **L)
 {
    T_Var *var;
 
    int waitfor=HODNOTA;
    int err;
-   parentheses = 0;
+   ctx->parentheses = 0;
    int par = 0;
 
    Expr_list *pom = NULL;
    Expr_list *last = NULL;
    *L = NULL; //inic listu
 
-   lex_rc = GetToken(&token);
+   ctx->lex_rc = GetToken(ctx, &ctx->token);
    TOKEN_CHECK;
-   while ((lex_rc != TOKEN_EOF) && (lex_rc != TOKEN_EOL)) {
-      switch (lex_rc) {
+   while ((ctx->lex_rc != TOKEN_EOF) && (ctx->lex_rc != TOKEN_EOL)) {
+      switch (ctx->lex_rc) {
       //-------------------op == HODNOTA---------------
       //--------------------CISLO---------------------
       case TOKEN_NUMBER:
          if (waitfor == HODNOTA) {
-            if (debug) printf("%d cislo\n",lex_rc);
+            if (debug) printf("%d cislo\n",ctx->lex_rc);
 
-            CALL_CHECK(GenerateVariable(FALSE, &var));
-            CDoubleToT_Var(atof(token.data),var);
+            CALL_CHECK(GenerateVariable(ctx, FALSE, &var));
+            CDoubleToT_Var(atof(ctx->token.data),var);
 
             GENERSHORT; //viz synan.h
+            pom->literal = TRUE;
 
             waitfor=OPERACE;
          }
@@ -917,12 +1019,13 @@ int gener_list(Expr_list **L)
        //--------------------STRING---------------------
       case TOKEN_STRING:
          if (waitfor == HODNOTA) {
-            if (debug) printf("%d string\n",lex_rc);
+            if (debug) printf("%d string\n",ctx->lex_rc);
 
-            CALL_CHECK(GenerateVariable(FALSE, &var));
-            T_StringToT_Var(&token,var);
+            CALL_CHECK(GenerateVariable(ctx, FALSE, &var));
+            T_StringToT_Var(&ctx->token,var);
 
             GENERSHORT;
+            pom->literal = TRUE;
 
             waitfor=OPERACE;
          }
@@ -933,44 +1036,47 @@ int gener_list(Expr_list **L)
          // 1 . nil , false , true
          if (waitfor == HODNOTA) {
             waitfor = OPERACE;
-            if (strcmp(token.data, "nil") == 0) {
-               if (debug) printf("%d nil\n", lex_rc);
+            if (strcmp(ctx->token.data, "nil") == 0) {
+               if (debug) printf("%d nil\n", ctx->lex_rc);
 
-               CALL_CHECK(GenerateVariable(FALSE, &var));
+               CALL_CHECK(GenerateVariable(ctx, FALSE, &var));
                var->NID = NID_NIL;
                GENERSHORT;
+               pom->literal = TRUE;
             }
 
-            else if (strcmp(token.data, "false") == 0) {
-               if (debug) printf("%d false\n", lex_rc);
+            else if (strcmp(ctx->token.data, "false") == 0) {
+               if (debug) printf("%d false\n", ctx->lex_rc);
 
-               CALL_CHECK(GenerateVariable(FALSE, &var));
+               CALL_CHECK(GenerateVariable(ctx, FALSE, &var));
 
                var->NID = NID_BOOL;
                var->vals.b_val = FALSE;
 
                GENERSHORT;
+               pom->literal = TRUE;
             }
 
-            else if (strcmp(token.data, "true") == 0) {
-               if (debug) printf("%d true\n", lex_rc);
+            else if (strcmp(ctx->token.data, "true") == 0) {
+               if (debug) printf("%d true\n", ctx->lex_rc);
 
-               CALL_CHECK(GenerateVariable(FALSE, &var));
+               CALL_CHECK(GenerateVariable(ctx, FALSE, &var));
 
                var->NID = NID_BOOL;
                var->vals.b_val = TRUE;
 
                GENERSHORT;
+               pom->literal = TRUE;
             }
 
             // 2. identifikatory - pouze ukladame ukaz na tabulku
-            else if (T_HTableExport(id_table, token.data, &var) == HASH_FOUND) {
-               if (debug) printf ("%s identifikator\n", token.data);
+            else if (T_HTableExport(ctx->id_table, ctx->token.data, &var) == HASH_FOUND) {
+               if (debug) printf ("%s identifikator\n", ctx->token.data);
 
                if (var->NID == NID_FUNCTION) { if (debug) printf("funkceeeeeeeeeeeeee");}
-               //CALL_CHECK(CallFunction());
-               //lex_rc=GetToken(&token);
-               //if ((lex_rc==EOL) || (lex_rc==EOF))
+               //CALL_CHECK(CallFunction(ctx));
+               //ctx->lex_rc=GetToken(ctx, &ctx->token);
+               //if ((ctx->lex_rc==EOL) || (ctx->lex_rc==EOF))
                //(*L)->value = nularet;
 
                GENERSHORT;
@@ -985,8 +1091,8 @@ int gener_list(Expr_list **L)
       case TOKEN_LBRACKET :
          if (waitfor == HODNOTA) {
             par--;
-            parentheses--;
-            if (debug) printf("%d levaz\n", lex_rc);
+            ctx->parentheses--;
+            if (debug) printf("%d levaz\n", ctx->lex_rc);
          }
          else { errno = SYNTACTIC_ERROR; if (debug) printf("cekam operaci"); return EXIT_FAILURE; }
       break;
@@ -995,11 +1101,11 @@ int gener_list(Expr_list **L)
       case TOKEN_RBRACKET :
          if (waitfor == OPERACE) {
             last->zavorka++;
-            parentheses++;
-            if (debug) printf("%d pravaz\n", lex_rc);
+            ctx->parentheses++;
+            if (debug) printf("%d pravaz\n", ctx->lex_rc);
          }
          else { errno = SYNTACTIC_ERROR; if (debug) printf("cekam hodnotu"); return EXIT_FAILURE; }
-         if (parentheses > 0) { errno=SYNTACTIC_ERROR; if (debug) printf("cekam hodnotu"); return EXIT_FAILURE; }
+         if (ctx->parentheses > 0) { errno=SYNTACTIC_ERROR; if (debug) printf("cekam hodnotu"); return EXIT_FAILURE; }
       break;
       //--------------------operace ---------------------
       case TOKEN_DSTAR:
@@ -1008,8 +1114,8 @@ int gener_list(Expr_list **L)
       case TOKEN_EQUAL:  case TOKEN_UNEQUAL:   case TOKEN_BEQUAL:
       case TOKEN_SMEQUAL:case TOKEN_SMALLER:   case TOKEN_BIGGER:
          if (waitfor==OPERACE) {
-            if (debug) printf("%d operace\n", lex_rc);
-            last->operace = lex_rc;
+            if (debug) printf("%d operace\n", ctx->lex_rc);
+            last->operace = ctx->lex_rc;
             waitfor = HODNOTA;
          }
          else { errno=SYNTACTIC_ERROR; if (debug) printf("cekam hodnotu"); return EXIT_FAILURE; }
@@ -1017,40 +1123,41 @@ int gener_list(Expr_list **L)
       //------------------------PRAVAZAVORKA----------------------------
       case TOKEN_LSBRACKET:
          if (waitfor==OPERACE) {
-            if (debug) printf("%d leva hranata zavorka\n",lex_rc);
+            if (debug) printf("%d leva hranata zavorka\n",ctx->lex_rc);
             if ((*L!=NULL)&&((*L)->next==NULL)) {
                T_Var *svar;
                T_Var *svar2;
 
-               if ((err = expr_string(&svar ,&svar2)) != EXIT_SUCCESS) return EXIT_FAILURE;
+               if ((err = expr_string(ctx, &svar ,&svar2)) != EXIT_SUCCESS) return EXIT_FAILURE;
                else {
                   if ((svar!=NULL)||(svar2!=NULL)) {
 
-                     CALL_CHECK(GenerateVariable(FALSE, &read_var));
+                     CALL_CHECK(GenerateVariable(ctx, FALSE, &ctx->read_var));
 
-                     read_var->NID=NID_STRING;
-                     GenerateInstruction(IID_COPY, read_var, (*L)->value, NULL);
+                     ctx->read_var->NID=NID_STRING;
+                     GenerateInstruction(IID_COPY, ctx->read_var, (*L)->value, NULL);
 
-                     GenerateInstruction(IID_CUT, read_var, svar, svar2);
+                     GenerateInstruction(IID_CUT, ctx->read_var, svar, svar2);
 
-                     (*L)->value=read_var;
+                     (*L)->value=ctx->read_var;
+                     (*L)->literal = FALSE;
                   }
-                  if ((lex_rc == TOKEN_EOL) || (lex_rc == TOKEN_EOF)) return EXIT_SUCCESS;
+                  if ((ctx->lex_rc == TOKEN_EOL) || (ctx->lex_rc == TOKEN_EOF)) return EXIT_SUCCESS;
                }
             }
          }
       else { errno=SYNTACTIC_ERROR; if (debug) printf("cekam hodnotu"); return EXIT_FAILURE;}
       break;
 
-      case TOKEN_BROKEN : if (debug) printf("%d lex chyba kdyz token brken chyba\n",lex_rc); return EXIT_FAILURE;
-      default : { errno = SYNTACTIC_ERROR; if (debug) printf("%d syn chyba kdyz token brken chyba\n", lex_rc); return EXIT_FAILURE;} break;
+      case TOKEN_BROKEN : if (debug) printf("%d lex chyba kdyz ctx->token brken chyba\n",ctx->lex_rc); return EXIT_FAILURE;
+      default : { errno = SYNTACTIC_ERROR; if (debug) printf("%d syn chyba kdyz ctx->token brken chyba\n", ctx->lex_rc); return EXIT_FAILURE;} break;
       }
 
-      lex_rc = GetToken(&token);
+      ctx->lex_rc = GetToken(ctx, &ctx->token);
       TOKEN_CHECK;
    }
    if (*L == NULL) { errno = SYNTACTIC_ERROR; if (debug) printf("prazdno"); return EXIT_FAILURE;}
-   if (parentheses != 0) { errno = SYNTACTIC_ERROR; if (debug) printf("spatne zavorky"); return EXIT_FAILURE;}
+   if (ctx->parentheses != 0) { errno = SYNTACTIC_ERROR; if (debug) printf("spatne zavorky"); return EXIT_FAILURE;}
    return EXIT_SUCCESS;
 }
 
@@ -1069,7 +1176,7 @@ int gener_list(Expr_list **L)
 //-------------------------------------------------------------------
 // pouze NUM-NUM
 
-int FIRST_eval(Expr_list**first, Expr_list** last)
+int FIRST_eval(T_Context *ctx, Expr_list**first, Expr_list** last)
 {
    Expr_list *pom;
    Expr_list *del;
@@ -1078,21 +1185,28 @@ int FIRST_eval(Expr_list**first, Expr_list** last)
    if (debug) printf("\n-----* /----\n");
    pom = *first;
    while ((pom != NULL) && (pom != *last)) {
-      if (pom->operace==TOKEN_DSTAR)
-         if (((pom->value->NID == NID_NUMBER) || (pom->value->NID == NID_UNDEF))
+      if (pom->operace==TOKEN_DSTAR) {
+         CALL_CHECK(FoldConstant(ctx, pom, &var));
+         if (var != NULL) {
+            pom->value = var;
+            MYSHORTCUT;
+         }
+         else if (((pom->value->NID == NID_NUMBER) || (pom->value->NID == NID_UNDEF))
             &&((pom->next->value->NID == NID_NUMBER) || (pom->next->value->NID == NID_UNDEF)))
          {
-            if (debug) printf("%f - %f  ** \n",pom->value->vals.d_val ,pom->next->value->vals.d_val );
+            if (debug) printf("%f - %f  ** \n",NUM_VAL(pom->value) ,NUM_VAL(pom->next->value) );
 
-            CALL_CHECK(GenerateVariable(FALSE, &var));
+            CALL_CHECK(GenerateVariable(ctx, FALSE, &var));
             var->NID=NID_NUMBER;
 
             GenerateInstruction(IID_PWR, var, pom->value, pom->next->value);
             pom->value=var;
+            pom->literal = FALSE;
 
             MYSHORTCUT;
          }
          else { errno = SEMANTIC_ERROR; if (debug) printf("semantika ** \n"); return EXIT_FAILURE; }
+      }
       else pom = pom->next;
    }
    return EXIT_SUCCESS;
@@ -1101,7 +1215,7 @@ int FIRST_eval(Expr_list**first, Expr_list** last)
 //-------------------------------------------------------------------
 // VYHODNOCENI LISTU PRO  *    /
 //-------------------------------------------------------------------
-int SECOND_eval(Expr_list** first, Expr_list** last)
+int SECOND_eval(T_Context *ctx, Expr_list** first, Expr_list** last)
 {
    Expr_list *pom;
    Expr_list *del;
@@ -1111,28 +1225,39 @@ int SECOND_eval(Expr_list** first, Expr_list** last)
    if (debug) printf("\n-----* /----\n");
    while ((pom != NULL) && (pom != *last)) {
       if (pom->operace == TOKEN_SLASH) {
-         if (((pom->value->NID == NID_NUMBER) || (pom->value->NID == NID_UNDEF))
+         CALL_CHECK(FoldConstant(ctx, pom, &var));
+         if (var != NULL) {
+            pom->value = var;
+            MYSHORTCUT;
+         }
+         else if (((pom->value->NID == NID_NUMBER) || (pom->value->NID == NID_UNDEF))
              &&((pom->next->value->NID == NID_NUMBER) || (pom->next->value->NID == NID_UNDEF)))
          {
-            if (debug) printf("%f - %f  / \n", pom->value->vals.d_val, pom->next->value->vals.d_val);
+            if (debug) printf("%f - %f  / \n", NUM_VAL(pom->value), NUM_VAL(pom->next->value));
 
-            CALL_CHECK(GenerateVariable(FALSE, &var));
+            CALL_CHECK(GenerateVariable(ctx, FALSE, &var));
             var->NID=NID_NUMBER;
 
             GenerateInstruction(IID_DIV, var, pom->value, pom->next->value);
 
             pom->value=var;
+            pom->literal = FALSE;
             MYSHORTCUT;
          }
          else { errno = SEMANTIC_ERROR; if (debug) printf("semantika / \n"); return EXIT_FAILURE; }
       }
       else if (pom->operace == TOKEN_STAR) {
-         if (((pom->value->NID == NID_NUMBER) || (pom->value->NID==NID_UNDEF) || (pom->value->NID==NID_STRING))
+         CALL_CHECK(FoldConstant(ctx, pom, &var));
+         if (var != NULL) {
+            pom->value = var;
+            MYSHORTCUT;
+         }
+         else if (((pom->value->NID == NID_NUMBER) || (pom->value->NID==NID_UNDEF) || (pom->value->NID==NID_STRING))
              &&((pom->next->value->NID == NID_NUMBER) || (pom->next->value->NID == NID_UNDEF)))
          {
-            if (debug) printf("%f - %f  * \n", pom->value->vals.d_val, pom->next->value->vals.d_val);
+            if (debug) printf("%f - %f  * \n", NUM_VAL(pom->value), NUM_VAL(pom->next->value));
 
-            CALL_CHECK(GenerateVariable(FALSE, &var));
+            CALL_CHECK(GenerateVariable(ctx, FALSE, &var));
 
             if (pom->value->NID == NID_NUMBER) var->NID = NID_NUMBER;
             if (pom->value->NID == NID_STRING) var->NID = NID_STRING;
@@ -1140,6 +1265,7 @@ int SECOND_eval(Expr_list** first, Expr_list** last)
             GenerateInstruction(IID_MUL, var, pom->value, pom->next->value);
 
             pom->value=var;
+            pom->literal = FALSE;
             MYSHORTCUT;
          }
          else { errno = SEMANTIC_ERROR; if (debug) printf("semantika * \n"); return EXIT_FAILURE; }
@@ -1152,7 +1278,7 @@ int SECOND_eval(Expr_list** first, Expr_list** last)
 //-------------------------------------------------------------------
 // VYHODNOCENI LISTU PRO  +    -
 //-------------------------------------------------------------------
-int THIRT_eval(Expr_list** first, Expr_list** last)
+int THIRT_eval(T_Context *ctx, Expr_list** first, Expr_list** last)
 {
    Expr_list *pom;
    Expr_list *del;
@@ -1161,36 +1287,50 @@ int THIRT_eval(Expr_list** first, Expr_list** last)
    pom=*first;
    if (debug) printf("\n-----+ - ----");
    while ((pom != NULL) && (pom != *last)) {
-      if (pom->operace == TOKEN_MINUS)
+      if (pom->operace == TOKEN_MINUS) {
+      CALL_CHECK(FoldConstant(ctx, pom, &var));
+      if (var != NULL) {
+         pom->value = var;
+         MYSHORTCUT;
+      }
       //------------------------NUM - NUM --------------------------
-      if (((pom->value->NID == NID_NUMBER) || (pom->value->NID == NID_UNDEF))
+      else if (((pom->value->NID == NID_NUMBER) || (pom->value->NID == NID_UNDEF))
           &&((pom->next->value->NID == NID_NUMBER) || (pom->next->value->NID == NID_UNDEF)))
       {
-         if (debug) printf("%f - %f  - \n", pom->value->vals.d_val, pom->next->value->vals.d_val);
-         CALL_CHECK(GenerateVariable(FALSE, &var));
+         if (debug) printf("%f - %f  - \n", NUM_VAL(pom->value), NUM_VAL(pom->next->value));
+         CALL_CHECK(GenerateVariable(ctx, FALSE, &var));
          var->NID = NID_NUMBER;
 
          GenerateInstruction(IID_DIFF, var, pom->value, pom->next->value);
 
          pom->value=var;
+         pom->literal = FALSE;
 
          MYSHORTCUT;
       }
       else { errno = SEMANTIC_ERROR; if (debug) printf("semantika -\n"); return EXIT_FAILURE; }
+      }
 
-      else if (pom->operace == TOKEN_PLUS)
+      else if (pom->operace == TOKEN_PLUS) {
+      CALL_CHECK(FoldConstant(ctx, pom, &var));
+      if (var != NULL) {
+         pom->value = var;
+         MYSHORTCUT;
+      }
       //------------------------NUM - NUM --------------------------
-      if ((pom->value->NID == NID_NUMBER) || (pom->value->NID == NID_UNDEF) || (pom->value->NID == NID_STRING)) {
-         if (debug) printf("%f - %f  + \n", pom->value->vals.d_val, pom->next->value->vals.d_val);
-         CALL_CHECK(GenerateVariable(FALSE, &var));
+      else if ((pom->value->NID == NID_NUMBER) || (pom->value->NID == NID_UNDEF) || (pom->value->NID == NID_STRING)) {
+         if (debug) printf("%f - %f  + \n", NUM_VAL(pom->value), NUM_VAL(pom->next->value));
+         CALL_CHECK(GenerateVariable(ctx, FALSE, &var));
          var->NID = pom->value->NID;
 
          GenerateInstruction(IID_PLUS, var, pom->value, pom->next->value);
          pom->value = var;
+         pom->literal = FALSE;
 
          MYSHORTCUT;
       }
       else { errno = SEMANTIC_ERROR; if (debug) printf("semantika + \n"); return EXIT_FAILURE; }
+      }
       else pom = pom->next;
    }
    return EXIT_SUCCESS;
@@ -1199,7 +1339,7 @@ int THIRT_eval(Expr_list** first, Expr_list** last)
 //-------------------------------------------------------------------
 // VYHODNOCENI LISTU PRO  > , >= ,<= < , != ,==
 //-------------------------------------------------------------------
-int FOURTH_eval(Expr_list**first, Expr_list** last)
+int FOURTH_eval(T_Context *ctx, Expr_list**first, Expr_list** last)
 {
    Expr_list *pom;
    Expr_list *del;
@@ -1210,21 +1350,29 @@ int FOURTH_eval(Expr_list**first, Expr_list** last)
    while ((pom != NULL) && (pom != *last)) {
       // mozne plynule vyhodnocovat prioritne na nejnizi urovni
       // v dane useku zbyly pouze operace relace
-      CALL_CHECK(GenerateVariable(FALSE, &var));
+      CALL_CHECK(FoldConstant(ctx, pom, &var));
+      if (var != NULL) {
+         pom->value = var;
+         MYSHORTCUT;
+         continue;
+      }
+
+      CALL_CHECK(GenerateVariable(ctx, FALSE, &var));
       var->NID = NID_BOOL;
 
       switch (pom->operace) {
-      case TOKEN_BIGGER  : T_InstrSet(&instr, IID_BIGGER, var, pom->value, pom->next->value); break;
-      case TOKEN_SMALLER : T_InstrSet(&instr, IID_SMALLER, var, pom->value, pom->next->value); break;
-      case TOKEN_BEQUAL  : T_InstrSet(&instr, IID_BEQUAL, var, pom->value, pom->next->value); break;
-      case TOKEN_SMEQUAL : T_InstrSet(&instr, IID_SMEQUAL, var, pom->value, pom->next->value); break;
-      case TOKEN_EQUAL   : T_InstrSet(&instr, IID_EQUAL, var, pom->value, pom->next->value); break;
-      case TOKEN_UNEQUAL : T_InstrSet(&instr, IID_UNEQUAL, var, pom->value, pom->next->value); break;
-      default : free(var); var = NULL;
+      case TOKEN_BIGGER  : T_InstrSet(&ctx->instr, IID_BIGGER, var, pom->value, pom->next->value); break;
+      case TOKEN_SMALLER : T_InstrSet(&ctx->instr, IID_SMALLER, var, pom->value, pom->next->value); break;
+      case TOKEN_BEQUAL  : T_InstrSet(&ctx->instr, IID_BEQUAL, var, pom->value, pom->next->value); break;
+      case TOKEN_SMEQUAL : T_InstrSet(&ctx->instr, IID_SMEQUAL, var, pom->value, pom->next->value); break;
+      case TOKEN_EQUAL   : T_InstrSet(&ctx->instr, IID_EQUAL, var, pom->value, pom->next->value); break;
+      case TOKEN_UNEQUAL : T_InstrSet(&ctx->instr, IID_UNEQUAL, var, pom->value, pom->next->value); break;
+      default : var = NULL; // patri tabulke identifikatorov
       }
       if (var!=NULL) {
-         T_ListAppend(inst_list, &instr);
+         T_ListAppend(ctx->inst_list, &ctx->instr);
          pom->value=var;
+         pom->literal = FALSE;
          MYSHORTCUT;
       }
    }
@@ -1234,15 +1382,15 @@ int FOURTH_eval(Expr_list**first, Expr_list** last)
 //-------------------------------------------------------------------
 // VYHODNOCENI LISTU PRO  pro usek First - Last
 //-------------------------------------------------------------------
-int eval(Expr_list* first, Expr_list* last)
+int eval(T_Context *ctx, Expr_list* first, Expr_list* last)
 {
   int err = 0;
   while ((first != last) && (err == 0)) {
     // postupne volani vyhodnoceni pro dany usek , konec v pripade chyby
-    if ((first != last) && (err == 0)) err = FIRST_eval(&first, &last); // **
-    if ((first != last) && (err == 0)) err = SECOND_eval(&first, &last); // * /
-    if ((first != last) && (err == 0)) err = THIRT_eval(&first, &last); // + -
-    if ((first != last) && (err == 0)) err = FOURTH_eval(&first, &last); // > , >= ,<= < , != ,==
+    if ((first != last) && (err == 0)) err = FIRST_eval(ctx, &first, &last); // **
+    if ((first != last) && (err == 0)) err = SECOND_eval(ctx, &first, &last); // * /
+    if ((first != last) && (err == 0)) err = THIRT_eval(ctx, &first, &last); // + -
+    if ((first != last) && (err == 0)) err = FOURTH_eval(ctx, &first, &last); // > , >= ,<= < , != ,==
   }
   return err;
 }
@@ -1251,7 +1399,7 @@ int eval(Expr_list* first, Expr_list* last)
 // NALEZENI USEKU UZAVOREK A VOLANI JEJICH VYHODNOCENI
 
 //-------------------------------------------------------------------
-int evaluate(Expr_list **L)
+int evaluate(T_Context *ctx, Expr_list **L)
 {
    Expr_list *first = NULL;
    Expr_list *last = NULL;
@@ -1274,7 +1422,7 @@ int evaluate(Expr_list **L)
             last = first;
             first = *L;
          }
-         err = eval(first, last);
+         err = eval(ctx, first, last);
 
          if (err != 0) return EXIT_FAILURE;
       }
@@ -1292,7 +1440,7 @@ void expr_free(Expr_list **L)
    while ((*L) != NULL) {
       pom = (*L);
       (*L) = pom->next;
-      free(pom);
+      POOL_DELETE(Expr_list, pom);
    }
    return;
 }
@@ -1305,20 +1453,20 @@ void expr_free(Expr_list **L)
 // nachazet hodnota
 // 4. Uvolneni listu a EXIT_FAILURE v pripade chyby
 //-------------------------------------------------------------------
-int expr()
+int expr(T_Context *ctx)
 {
    int err = 0;
    Expr_list *List;
 
-   err = gener_list(&List);
+   err = gener_list(ctx, &List);
 
    if (err == 0)
      if (List->next != NULL)
-       err=evaluate(&List);
+       err=evaluate(ctx, &List);
 
    if (err == 0) {
-      read_var=List->value;
-      free(List);
+      ctx->read_var=List->value;
+      POOL_DELETE(Expr_list, List);
    }
    else expr_free(&List);
 
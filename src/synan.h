@@ -24,15 +24,16 @@
 	del=pom->next;\
 	pom->next=del->next;\
 	if (del==*last) *last=pom;\
-	free(del);\
+	POOL_DELETE(struct Exlist, del);\
 	} while (0)
 
 #define GENERSHORT do{ \
-         pom=malloc(sizeof(struct Exlist));\
+         pom=POOL_NEW(struct Exlist);\
 	 PTR_CHECK(pom);\
          pom->value=var;\
          pom->operace=TOKEN_EOL;\
          pom->zavorka=par; par=0;\
+         pom->literal=FALSE;\
          pom->next=NULL;\
          if (*L==NULL) {	last=pom;	*L=pom;     }\
          else     {	        last->next=pom;	last=pom;   }	\
@@ -69,9 +70,9 @@
 <end>		-> end EOL
 */
 
-int SynanInit(T_List *inst_list, T_AllocList *alloc_list, T_LabelList *label_list);
-void SynanFinish();
+int SynanInit(T_Context *ctx, T_List *inst_list, T_LabelList *label_list);
+void SynanFinish(T_Context *ctx);
 
-int Synan();
+int Synan(T_Context *ctx);
 
 #endif
@@ -12,14 +12,27 @@
 #include <stdio.h> // FILE
 #include <errno.h>
 #include <stdint.h>
+#include <math.h> // signbit()
+#include <sys/mman.h> // munmap()
 
+#include "alloc.h"
 #include "types.h"
 #include "codes.h"
 #include "macros.h" // PTR_CHECK()
 #include "debug.h"
+#include "ial.h"
 #include "functions.h"
 #include "synan.h"
 
+// Hlavicka buffra retazca, na ktoreho znaky ukazuje data
+#define DATA_HEAD(data) ((T_StringHead *)(void *)(data) - 1)
+
+static void RopeRelease(T_Rope *node);
+static char *RopeBytes(T_Rope *node);
+static T_Rope *RopeOf(T_Var *var);
+static char *StringBuffer(char *data, size_t capacity);
+static void StringBufferFree(char *data);
+
 // T_Var ----------------------------------------------------------------------
 int T_VarInit(T_Var *var)
 {
@@ -27,6 +40,8 @@ int T_VarInit(T_Var *var)
    PTR_CHECK(var);
 
 	var->NID = NID_UNDEF;
+   var->sub = SUB_NONE;
+   var->vals.str.data = NULL;
 
    DEBUG_VAR_INIT_END(var);
    return EXIT_SUCCESS;
@@ -37,7 +52,12 @@ void T_VarDelete(T_Var *var)
    DEBUG_VAR_DELETE(var);
 
    if (var != NULL) {
-      if (var->NID == NID_STRING)
+      if (IS_ROPE(var)) {
+         RopeRelease(var->vals.rope);
+         var->vals.str.data = NULL;
+         var->sub = SUB_NONE;
+      }
+      else if (var->NID == NID_STRING)
          T_StringDelete(&var->vals.str);
 
       var->NID = NID_UNDEF;
@@ -56,9 +76,16 @@ int T_VarCopy(T_Var *write_var, T_Var *read_var)
    T_VarInit(write_var);
 
    DEBUG_VAR_COPY_PRECOPY(write_var, read_var);
-   if (read_var->NID == NID_STRING)
-      T_StringToT_Var(&(read_var->vals.str), write_var);
-
+   if (IS_ROPE(read_var)) {
+      // Kopia ma vlastny buffer, uzly ropu zdiela len T_VarShare()
+      char *data = RopeBytes(read_var->vals.rope);
+      PTR_CHECK(data);
+      write_var->NID = NID_STRING;
+      write_var->vals.str.data = data;
+   }
+   else if (read_var->NID == NID_STRING) {
+      CALL_CHECK(T_StringToT_Var(&(read_var->vals.str), write_var));
+   }
    else if (write_var->NID == NID_CONST) {
       errno = SEMANTIC_ERROR;
       return EXIT_FAILURE;
@@ -71,13 +98,47 @@ int T_VarCopy(T_Var *write_var, T_Var *read_var)
    return EXIT_SUCCESS;
 }
 
+/* Ako T_VarCopy(), ale dlhy retazec sa nekopiruje. Oba T_Var potom
+   zdielaju jeden buffer cez list ropu s poctom referencii a kopiu dostane
+   az ten, kto retazec meni (T_VarFlatten()). Kratsi retazec ako ROPE_LEAF
+   sa kopiruje. Oba T_Var musia patrit tej istej halde alebo arene.
+*/
+int T_VarShare(T_Var *write_var, T_Var *read_var)
+{
+   PTR_CHECK(read_var);
+   PTR_CHECK(write_var);
+
+   if (write_var == read_var)
+      return EXIT_SUCCESS;
+   if (read_var->NID != NID_STRING || (!IS_ROPE(read_var) && STRING_LENGTH(&read_var->vals.str) < ROPE_LEAF))
+      return T_VarCopy(write_var, read_var);
+
+   T_Rope *node = RopeOf(read_var);
+   PTR_CHECK(node);
+
+   T_VarDelete(write_var);
+   write_var->NID = NID_STRING;
+   write_var->sub = SUB_ROPE;
+   write_var->vals.rope = node;
+   return EXIT_SUCCESS;
+}
+
 int CDoubleToT_Var(double val, T_Var *var)
 {
    DEBUG_DOUBLE2VAR(val, var);
    PTR_CHECK(var);
 
 	var->NID = NID_NUMBER;
-	var->vals.d_val = val;
+
+   // Cele cislo (nie -0.0) sa ulozi ako int64_t pre celociselnu aritmetiku
+   if (val > -INT_LIMIT && val < INT_LIMIT && val == (double)(int64_t)val && !(val == 0.0 && signbit(val))) {
+      var->sub = SUB_INT;
+      var->vals.i_val = (int64_t)val;
+   }
+   else {
+      var->sub = SUB_NONE;
+      var->vals.d_val = val;
+   }
 
    DEBUG_DOUBLE2VAR_END(val, var);
    return EXIT_SUCCESS;
@@ -89,20 +150,331 @@ int T_StringToT_Var(T_String *str, T_Var *var)
    PTR_CHECK(str);
    PTR_CHECK(var);
 
-	var->NID = NID_STRING;
-	var->vals.str.length = str->length;
+   // Premenna, ktora ma typ retazec urceny len pri preklade, nema data
+   if (str->data == NULL) {
+      CALL_CHECK(T_StringInit(&var->vals.str));
+      var->NID = NID_STRING;
+      return EXIT_SUCCESS;
+   }
+
+   uint32_t length = STRING_HEAD(str)->length;
+   char *tmp = StringBuffer(NULL, (size_t)length / TSTRING_SIZE * TSTRING_SIZE + TSTRING_SIZE);
+   PTR_CHECK(tmp);
 
-   size_t req_size = str->length + TSTRING_SIZE - (str->length % TSTRING_SIZE);
-	char *tmp = malloc(req_size);
-	PTR_CHECK(tmp);
+   memcpy(tmp, str->data, length);
+   tmp[length] = '\0';
+   DATA_HEAD(tmp)->length = length;
 
-	var->vals.str.data = tmp;
-	memcpy(var->vals.str.data, str->data, req_size);
+   var->NID = NID_STRING;
+   var->vals.str.data = tmp;
 
    DEBUG_STRING2VAR_END(str, var);
    return EXIT_SUCCESS;
 }
 
+// T_Rope ---------------------------------------------------------------------
+/* Rekurzia ide vzdy do kratsieho podstromu a dlhsi sa spracuje v cykle,
+   hlbka rekurzie je tak najviac log2 dlzky retazca.
+*/
+static void RopeRelease(T_Rope *node)
+{
+   while (node != NULL && --node->refs == 0) {
+      T_Rope *next = NULL;
+      if (node->left == NULL)
+         StringBufferFree(node->data);
+      else if (node->left->length < node->right->length) {
+         RopeRelease(node->left);
+         next = node->right;
+      }
+      else {
+         RopeRelease(node->right);
+         next = node->left;
+      }
+      MemFree(node);
+      node = next;
+   }
+}
+
+// Zapise bajty ropu do dest
+static void RopeFill(T_Rope *node, char *dest)
+{
+   while (node->left != NULL) {
+      if (node->left->length < node->right->length) {
+         RopeFill(node->left, dest);
+         dest += node->left->length;
+         node = node->right;
+      }
+      else {
+         RopeFill(node->right, dest + node->left->length);
+         node = node->left;
+      }
+   }
+   memcpy(dest, node->data, node->length);
+}
+
+/* Zapise do dest length bajtov ropu od pozicie from. Ako RopeFill()
+   sa vnara do mensieho podstromu, hlbka rekurzie tak zostava logaritmicka.
+*/
+static void RopeFillRange(T_Rope *node, uint32_t from, uint32_t length, char *dest)
+{
+   while (node->left != NULL) {
+      uint32_t left = node->left->length;
+      if (from + length <= left)
+         node = node->left;
+      else if (from >= left) {
+         from -= left;
+         node = node->right;
+      }
+      else if (left < node->right->length) {
+         RopeFillRange(node->left, from, left - from, dest);
+         dest += left - from;
+         length -= left - from;
+         from = 0;
+         node = node->right;
+      }
+      else {
+         RopeFillRange(node->right, 0, from + length - left, dest + left - from);
+         length = left - from;
+         node = node->left;
+      }
+   }
+   memcpy(dest, node->data + from, length);
+}
+
+// Novy buffer retazca s obsahom ropu
+static char *RopeBytes(T_Rope *node)
+{
+   char *data = StringBuffer(NULL, ((size_t)node->length / TSTRING_SIZE + 1) * TSTRING_SIZE);
+   if (data != NULL) {
+      RopeFill(node, data);
+      data[node->length] = '\0';
+      DATA_HEAD(data)->length = node->length;
+   }
+   return data;
+}
+
+// Novy list s bajtami x a za nimi y
+static T_Rope *RopeLeaf(const char *x, uint32_t x_length, const char *y, uint32_t y_length)
+{
+   T_Rope *leaf = MemAlloc(sizeof(T_Rope));
+   if (leaf == NULL)
+      return NULL;
+   if ((leaf->data = StringBuffer(NULL, (size_t)x_length + y_length + 1)) == NULL) {
+      MemFree(leaf);
+      return NULL;
+   }
+
+   // Prazdna cast moze byt NULL, memcpy() ju nesmie dostat ani s dlzkou 0
+   if (x_length > 0)
+      memcpy(leaf->data, x, x_length);
+   if (y_length > 0)
+      memcpy(leaf->data + x_length, y, y_length);
+   leaf->data[x_length + y_length] = '\0';
+   DATA_HEAD(leaf->data)->length = x_length + y_length;
+   leaf->refs = 1;
+   leaf->length = x_length + y_length;
+   leaf->left = NULL;
+   leaf->right = NULL;
+   return leaf;
+}
+
+/* Vrati novu referenciu na rope s obsahom var. Kratky plochy retazec sa
+   skopiruje do listu, dlhy sa do listu presunie a var ho dalej zdiela.
+*/
+static T_Rope *RopeOf(T_Var *var)
+{
+   if (IS_ROPE(var)) {
+      var->vals.rope->refs++;
+      return var->vals.rope;
+   }
+   uint32_t length = STRING_LENGTH(&var->vals.str);
+   if (length < ROPE_LEAF)
+      return RopeLeaf(var->vals.str.data, length, NULL, 0);
+
+   T_Rope *leaf = MemAlloc(sizeof(T_Rope));
+   if (leaf == NULL)
+      return NULL;
+
+   leaf->refs = 2;
+   leaf->length = length;
+   leaf->left = NULL;
+   leaf->right = NULL;
+   leaf->data = var->vals.str.data;
+
+   var->sub = SUB_ROPE;
+   var->vals.rope = leaf;
+   return leaf;
+}
+
+// Kratky list, ku ktoremu sa zmesti length dalsich bajtov
+static int RopeShortLeaf(T_Rope *node, uint32_t length)
+{
+   return node->left == NULL && node->length + length <= ROPE_LEAF;
+}
+
+/* Uzol a + b, oba retazce su neprazdne. Kratky plochy retazec na kraji
+   ropu sa spoji so susednym kratkym listom, aby pripajanie po kusoch
+   nevytvaralo uzol na kazdy kus.
+*/
+static T_Rope *RopeJoin(T_Var *a, T_Var *b)
+{
+   T_Rope *left;
+   T_Rope *right;
+
+   if (IS_ROPE(a) && !IS_ROPE(b) && a->vals.rope->left != NULL
+       && RopeShortLeaf(a->vals.rope->right, STRING_LENGTH(&b->vals.str)))
+   {
+      T_Rope *last = a->vals.rope->right;
+      left = a->vals.rope->left;
+      left->refs++;
+      right = RopeLeaf(last->data, last->length, b->vals.str.data, STRING_LENGTH(&b->vals.str));
+   }
+   else if (IS_ROPE(b) && !IS_ROPE(a) && b->vals.rope->left != NULL
+            && RopeShortLeaf(b->vals.rope->left, STRING_LENGTH(&a->vals.str)))
+   {
+      T_Rope *first = b->vals.rope->left;
+      left = RopeLeaf(a->vals.str.data, STRING_LENGTH(&a->vals.str), first->data, first->length);
+      right = b->vals.rope->right;
+      right->refs++;
+   }
+   else {
+      left = RopeOf(a);
+      right = (left != NULL) ? RopeOf(b) : NULL;
+   }
+
+   T_Rope *node = (left != NULL && right != NULL) ? MemAlloc(sizeof(T_Rope)) : NULL;
+   if (node == NULL) {
+      RopeRelease(left);
+      RopeRelease(right);
+      return NULL;
+   }
+
+   node->refs = 1;
+   node->length = left->length + right->length;
+   node->left = left;
+   node->right = right;
+   node->data = NULL;
+   return node;
+}
+
+/* Do dest zapise retazec a + b bez kopirovania dlhych operandov, vysledok
+   od ROPE_LEAF znakov je rope. dest moze byt aj jeden z operandov.
+*/
+int T_VarConcat(T_Var *dest, T_Var *a, T_Var *b)
+{
+   PTR_CHECK(dest);
+   PTR_CHECK(a);
+   PTR_CHECK(b);
+
+   size_t length = (size_t)VAR_LENGTH(a) + VAR_LENGTH(b);
+   if (length >= UINT32_MAX) {
+      errno = INTERNAL_ERROR;
+      return EXIT_FAILURE;
+   }
+
+   T_Var result;
+   T_VarInit(&result);
+   result.NID = NID_STRING;
+
+   // Kratky vysledok zostane plochy, rope ma vzdy aspon ROPE_LEAF znakov
+   if (length < ROPE_LEAF) {
+      if (T_StringReserve(&result.vals.str, length) == EXIT_FAILURE
+          || T_StringCopy(&result.vals.str, &a->vals.str) == EXIT_FAILURE
+          || T_StringCat(&result.vals.str, &b->vals.str) == EXIT_FAILURE)
+      {
+         T_StringDelete(&result.vals.str);
+         return EXIT_FAILURE;
+      }
+      T_VarDelete(dest);
+      *dest = result;
+      return EXIT_SUCCESS;
+   }
+
+   T_Rope *node;
+   if (VAR_LENGTH(a) == 0)
+      node = RopeOf(b);
+   else if (VAR_LENGTH(b) == 0)
+      node = RopeOf(a);
+   else
+      node = RopeJoin(a, b);
+
+   if (node == NULL) {
+      errno = INTERNAL_ERROR;
+      return EXIT_FAILURE;
+   }
+
+   result.sub = SUB_ROPE;
+   result.vals.rope = node;
+   T_VarDelete(dest);
+   *dest = result;
+   return EXIT_SUCCESS;
+}
+
+/* Spoji rope vo var do jedneho buffra, inak nerobi nic. Volaju ju vsetci,
+   ktori potrebuju bajty retazca v pamati za sebou.
+*/
+int T_VarFlatten(T_Var *var)
+{
+   PTR_CHECK(var);
+   if (!IS_ROPE(var))
+      return EXIT_SUCCESS;
+
+   T_Rope *node = var->vals.rope;
+   char *data;
+
+   // Jediny drzitel listu si jeho buffer aj s hlavickou zoberie spat
+   if (node->left == NULL && node->refs == 1) {
+      data = node->data;
+      MemFree(node);
+   }
+   else {
+      if ((data = RopeBytes(node)) == NULL) {
+         errno = INTERNAL_ERROR;
+         return EXIT_FAILURE;
+      }
+      RopeRelease(node);
+   }
+
+   var->sub = SUB_NONE;
+   var->vals.str.data = data;
+   return EXIT_SUCCESS;
+}
+
+/* Podretazec retazca vo var od from do to ako CutString(). Rope alebo
+   zdielany list sa nespaja ani nekopiruje cely, precita sa len rozsah.
+*/
+int T_VarCut(T_String *substring, T_Var *var, int64_t from, int64_t to)
+{
+   PTR_CHECK(substring);
+   PTR_CHECK(var);
+   if (!IS_ROPE(var))
+      return CutString(substring, &var->vals.str, from, to);
+
+   CALL_CHECK(T_StringReserve(substring, 0));
+   STRING_HEAD(substring)->length = 0;
+   substring->data[0] = '\0';
+
+   if (from >= 0 && from < to && var->vals.rope->length >= to) {
+      CALL_CHECK(T_StringReserve(substring, to - from));
+      RopeFillRange(var->vals.rope, from, to - from, substring->data);
+      substring->data[to - from] = '\0';
+      STRING_HEAD(substring)->length = strlen(substring->data);
+   }
+   return EXIT_SUCCESS;
+}
+
+// Prvy znak retazca, '\0' pre prazdny, rope sa kvoli nemu nespaja
+char T_VarFirstChar(T_Var *var)
+{
+   if (!IS_ROPE(var))
+      return (var->vals.str.data != NULL) ? var->vals.str.data[0] : '\0';
+
+   T_Rope *node = var->vals.rope;
+   while (node->left != NULL)
+      node = node->left;
+   return node->data[0];
+}
+
 int IsFunction(T_Var *var)
 {
    return (var->NID == NID_FUNCTION);
@@ -131,14 +503,20 @@ void T_VarPrint(T_Var *var)
       printf("  Boolean(%p) = %s\n", (void *)var, (var->vals.b_val != 0 ? "TRUE" : "FALSE") );
       break;
     case 3:
-      printf("  Number(%p) = %f\n", (void *)var, var->vals.d_val);
+      printf("  Number(%p) = %f\n", (void *)var, NUM_VAL(var));
       break;
     case 6:
-      printf("  Function(%p): size=%d, ", (void *)var, var->vals.args.size);
-      T_ArgListPrint(&(var->vals.args));
+      printf("  Function(%p): size=%d, ", (void *)var, var->vals.args != NULL ? var->vals.args->size : 0);
+      if (var->vals.args != NULL)
+         T_ArgListPrint(var->vals.args);
+      else
+         printf("\n");
       break;
     case 8:
-      printf("  String(%p) = \"%s\"\n", (void *)var, var->vals.str.data);
+      if (var->sub == SUB_ROPE)
+         printf("  Rope(%p): length=%u\n", (void *)var, var->vals.rope->length);
+      else
+         printf("  String(%p) = \"%s\"\n", (void *)var, var->vals.str.data);
       break;
     default:
       printf("  Unknown NID(%p)\n", (void *)var);
@@ -147,31 +525,82 @@ void T_VarPrint(T_Var *var)
 }
 
 // T_String -------------------------------------------------------------------
+/* Zvacsi buffer data na capacity bajtov za hlavickou, NULL alokuje novy
+   prazdny retazec. Dlzka aj obsah sa zachovaju, pri chybe vrati NULL.
+*/
+static char *StringBuffer(char *data, size_t capacity)
+{
+   T_StringHead *head = MemRealloc(data != NULL ? DATA_HEAD(data) : NULL,
+                                   sizeof(T_StringHead) + capacity);
+   if (head == NULL)
+      return NULL;
+
+   if (data == NULL) {
+      head->length = 0;
+      ((char *)(head + 1))[0] = '\0';
+   }
+   head->capacity = capacity;
+   return (char *)(head + 1);
+}
+
+static void StringBufferFree(char *data)
+{
+   if (data != NULL)
+      MemFree(DATA_HEAD(data));
+}
+
 int T_StringInit(T_String *str)
 {
    DEBUG_STRINGINIT(str);
    PTR_CHECK(str);
 
-   str->length = 0;
-   if ((str->data = malloc(sizeof(char)*TSTRING_SIZE)) == NULL) {
+   if ((str->data = StringBuffer(NULL, TSTRING_SIZE)) == NULL) {
       errno = INTERNAL_ERROR;
       return EXIT_FAILURE;
    }
-   str->data[0] = '\0';
 
    DEBUG_STRINGINIT_END(str);
    return EXIT_SUCCESS;
 }
 
+/* Zabezpeci miesto pre length znakov a ukoncovaciu nulu. Pri zvacseni
+   kapacita aspon zdvojnasobi, pripajanie po znakoch je tak amortizovane
+   O(1). Obsah retazca sa zachova.
+*/
+int T_StringReserve(T_String *str, size_t length)
+{
+   PTR_CHECK(str);
+
+   size_t capacity = (str->data != NULL) ? STRING_HEAD(str)->capacity : 0;
+   if (length < capacity)
+      return EXIT_SUCCESS;
+
+   if (length >= UINT32_MAX) {
+      errno = INTERNAL_ERROR;
+      return EXIT_FAILURE;
+   }
+
+   size_t size = (length / TSTRING_SIZE + 1) * TSTRING_SIZE;
+   if (size < capacity * 2)
+      size = capacity * 2;
+   if (size > UINT32_MAX)
+      size = UINT32_MAX;
+
+   char *data = StringBuffer(str->data, size);
+   if (data == NULL) {
+      errno = INTERNAL_ERROR;
+      return EXIT_FAILURE;
+   }
+   str->data = data;
+   return EXIT_SUCCESS;
+}
+
 void T_StringDelete(T_String *str)
 {
    DEBUG_STRING_DELETE(str);
    if (str != NULL) {
-      if (str->data != NULL) {
-         free(str->data);
-         str->data = NULL;
-      }
-      str->length = 0;
+      StringBufferFree(str->data);
+      str->data = NULL;
    }
 
    DEBUG_STRING_DELETE_END(str);
@@ -184,12 +613,17 @@ int T_StringCopy(T_String *dest, T_String *src)
    PTR_CHECK(src);
    DEBUG_STRING_COPY_1(dest,src);
 
-   T_StringDelete(dest);
-   size_t  req_size = src->length / TSTRING_SIZE * TSTRING_SIZE + TSTRING_SIZE;
-   dest->data = malloc(req_size);
-   memcpy(dest->data, src->data, req_size);
+   if (dest == src)
+      return EXIT_SUCCESS;
+
+   // Buffer ciela sa pouzije znova, ak je dost velky
+   uint32_t length = STRING_LENGTH(src);
+   CALL_CHECK(T_StringReserve(dest, length));
+   if (length > 0)
+      memcpy(dest->data, src->data, length);
+   dest->data[length] = '\0';
 
-   dest->length = src->length;
+   STRING_HEAD(dest)->length = length;
    DEBUG_STRING_COPY_2(dest,src);
    return EXIT_SUCCESS;
 }
@@ -203,34 +637,38 @@ uint32_t T_StringRead(FILE *fd, T_String *str, char end)
       return fscanf(fd, "%*s");
 
    // Checks whether string isn't already full, flushes it in that case
-   if (str->length > 0) {
+   if (STRING_LENGTH(str) > 0) {
       T_StringDelete(str);
       T_StringInit(str);
    }
+   if (T_StringReserve(str, 0) == EXIT_FAILURE)
+      return EXIT_SUCCESS;
 
    // Reads characters from a file and saves it dynamically inside T_String
-   for (int c = fgetc(fd); !errno && c != EOF && c != end; c = fgetc(fd)) {
-      str->data[str->length] = c;
-      str->length++;
+   // Chybu citania urci len ferror(), errno moze byt nastavene zvonka
+   uint32_t length = 0;
+   int failed = 0;
+   for (int c = fgetc(fd); c != EOF && c != end; c = fgetc(fd)) {
+      // Extends allocated size when needed, sets errno on failure
+      if ((failed = T_StringReserve(str, (size_t)length + 1)) == EXIT_FAILURE)
+         break;
 
-      // Extends allocated size when needed
-      if ((str->length > 0) && !(str->length % TSTRING_SIZE)) {
-         if (realloc(str->data, (sizeof(char)*str->length)+(sizeof(char)*TSTRING_SIZE)) == NULL) {
-            errno = INTERNAL_ERROR;
-            return EXIT_SUCCESS;
-         }
-      }
+      str->data[length] = c;
+      length++;
    }
 
    // Adds string termination symbol
-   str->data[str->length] = '\0';
+   str->data[length] = '\0';
+   STRING_HEAD(str)->length = length;
+   if (failed)
+      return EXIT_SUCCESS;
 
    // An error has occured during reading an opened file
    if (ferror(fd))
       errno=INTERNAL_ERROR;
 
    DEBUG_STRINGREAD_END(str);
-   return str->length;
+   return length;
 }
 
 // Prida znak na konec retezce
@@ -240,20 +678,13 @@ int T_StringAppend(T_String *str, int c)
    PTR_CHECK(str);
 
    DEBUG_STRINGAPPEND(str,c);
-   // Prida znak
-   str->data[str->length] = c;
-   str->length++;
-
-   if ((str->length > 0) && !(str->length % TSTRING_SIZE)) {
-      char *nove;
-      if ((nove = realloc(str->data, (sizeof(char)*str->length)+(sizeof(char)*TSTRING_SIZE))) == NULL) {
-         errno = INTERNAL_ERROR;
-         return EXIT_FAILURE;
-      }
-      str->data = nove;
-   }
+   uint32_t length = STRING_LENGTH(str);
+   CALL_CHECK(T_StringReserve(str, (size_t)length + 1));
 
-   str->data[str->length] = '\0';
+   // Prida znak
+   str->data[length] = c;
+   str->data[length + 1] = '\0';
+   STRING_HEAD(str)->length = length + 1;
    DEBUG_STRINGAPPEND_END(str);
    return EXIT_SUCCESS;
 }
@@ -266,22 +697,18 @@ int T_StringCat(T_String *dest, T_String *src)
    PTR_CHECK(src);
 
    DEBUG_STRINGCAT(src);
-   // Zvetsi alokovany prostor v destinaci, aby se tam veslo i src, opet lehka vykradacka Vudce
-   if ((src->length > 0)) {
-    char *nove;
-    int len = dest->length + src->length; //delka spojenych stringu
-    // realokace destinace na spravnou delku odpovidajici nasobku osmi
-         if ((nove = realloc(dest->data, (sizeof(char) * (len + TSTRING_SIZE - (len % TSTRING_SIZE))))) == NULL) {
-            errno = INTERNAL_ERROR;
-            return EXIT_FAILURE;
-         }
-         dest->data = nove;
+   // Zvetsi alokovany prostor v destinaci, aby se tam veslo i src
+   if (STRING_LENGTH(src) > 0) {
+      uint32_t length = STRING_LENGTH(src); // src moze byt dest
+      uint32_t start = STRING_LENGTH(dest);
+      CALL_CHECK(T_StringReserve(dest, (size_t)start + length));
+
+      //samotna konkatenace podle delek a zmena informace o velikosti
+      memcpy(dest->data + start, src->data, length);
+      dest->data[start + length] = '\0';
+      STRING_HEAD(dest)->length = start + length;
    }
 
-   //samotna konkatenace a zmena informace o velikosti
-   dest->length += src->length;
-   strcat(dest->data, src->data);
-
    DEBUG_STRINGCAT_END(dest,src);
    return EXIT_SUCCESS;
 }
@@ -294,14 +721,14 @@ int CStringToT_String(char *c_str, T_String *str)
 
    T_StringDelete(str);
 
-   size_t req_size = strlen(c_str) / TSTRING_SIZE * TSTRING_SIZE + TSTRING_SIZE;
+   size_t length = strlen(c_str);
+   size_t req_size = length / TSTRING_SIZE * TSTRING_SIZE + TSTRING_SIZE;
 
-   str->data = malloc(req_size);
+   str->data = StringBuffer(NULL, req_size);
    PTR_CHECK(str->data);
 
-   strcpy(str->data, c_str);
-
-   str->length = strlen(c_str);
+   memcpy(str->data, c_str, length + 1);
+   STRING_HEAD(str)->length = length;
 
    DEBUG_CSTR2TSTR_END(c_str,str);
    return EXIT_SUCCESS;
@@ -314,14 +741,14 @@ int T_StackInit(T_Stack *stack)
    PTR_CHECK(stack);
 
    // Allocate space for pointer array
-   if ((stack->item = malloc(TSTACK_SIZE * sizeof(T_Var *))) == NULL) {
+   if ((stack->item = MemAlloc(TSTACK_SIZE * sizeof(T_Var *))) == NULL) {
       errno = INTERNAL_ERROR;
       return EXIT_FAILURE;
    }
 
    // Allocate space for array items
    for (int i = 0; i < TSTACK_SIZE; i++) {
-      if ((stack->item[i] = malloc(sizeof(T_Var))) == NULL) {
+      if ((stack->item[i] = MemAlloc(sizeof(T_Var))) == NULL) {
          errno = INTERNAL_ERROR;
          return EXIT_FAILURE;
       }
@@ -342,11 +769,11 @@ int TStack_Delete(T_Stack *stack)
       T_VarDelete(stack->item[i]);
    }
    T_VarDelete(stack->item[0]);
-   free(stack->item);
+   MemFree(stack->item);
 
    stack->pointer = NULL;
 
-   free(stack);
+   MemFree(stack);
 
    return EXIT_SUCCESS;
 }
@@ -396,14 +823,14 @@ int T_StackExtend(T_Stack *stack)
    uint32_t space = stack->size / TSTACK_SIZE + 1;
 
    // Allocate space for pointer array
-   if ((realloc(stack->item, space * sizeof(T_Var *))) == NULL) {
+   if ((MemRealloc(stack->item, space * sizeof(T_Var *))) == NULL) {
       errno = INTERNAL_ERROR;
       return EXIT_FAILURE;
    }
 
    // Allocate space for array items
    for (int i = 0; i < TSTACK_SIZE; i++) {
-      if ((realloc(stack->item[i], sizeof(T_Var))) == NULL) {
+      if ((MemRealloc(stack->item[i], sizeof(T_Var))) == NULL) {
          errno = INTERNAL_ERROR;
          return EXIT_FAILURE;
       }
@@ -460,7 +887,8 @@ void T_ListDelete(T_List *list)
       while (list->first != NULL) {
          pom = list->first;
          list->first = pom->next;
-         free(pom);
+         POOL_DELETE(T_Instr, pom->data);
+         POOL_DELETE(T_ListItem, pom);
       }
 
       list->actual = NULL;
@@ -485,11 +913,11 @@ int T_ListAppend(T_List *list, T_Instr *instr)
 
    DEBUG_TLISTAPPEND(list, instr);
    T_ListItem *pom;
-   pom = malloc(sizeof(T_ListItem));
+   pom = POOL_NEW(T_ListItem);
 
    PTR_CHECK(pom);
 
-   pom->data = malloc(sizeof(T_Instr));
+   pom->data = POOL_NEW(T_Instr);
    memcpy(pom->data, instr, sizeof(T_Instr));
 
    pom->next = NULL;
@@ -507,6 +935,253 @@ int T_ListAppend(T_List *list, T_Instr *instr)
    return EXIT_SUCCESS;
 }
 
+// T_Program ------------------------------------------------------------------
+
+/* Alokuje suvisle pole size instrukcii zarovnane na PROGRAM_ALIGN,
+   aby interpret pri behu necestoval po ukazovateloch zoznamu, a nslots
+   nedefinovanych slotov ramca.
+*/
+int T_ProgramInit(T_Program *program, uint32_t size, uint32_t nslots)
+{
+   PTR_CHECK(program);
+
+   program->code = NULL;
+   program->size = 0;
+   program->slots = NULL;
+   program->nslots = 0;
+   program->globals = NULL;
+   program->nglobals = 0;
+   program->image = NULL;
+   program->image_size = 0;
+
+   if (size > 0) {
+      if ((program->code = MemAllocAligned(size * sizeof(T_Code), PROGRAM_ALIGN)) == NULL) {
+         errno = INTERNAL_ERROR;
+         return EXIT_FAILURE;
+      }
+      program->size = size;
+   }
+
+   if (nslots > 0) {
+      if ((program->slots = MemAlloc(nslots * sizeof(T_Var))) == NULL) {
+         T_ProgramDelete(program);
+         errno = INTERNAL_ERROR;
+         return EXIT_FAILURE;
+      }
+      program->nslots = nslots;
+
+      for (uint32_t i = 0; i < nslots; i++)
+         T_VarInit(&program->slots[i]);
+   }
+
+   return EXIT_SUCCESS;
+}
+
+void T_ProgramDelete(T_Program *program)
+{
+   if (program != NULL) {
+      for (uint32_t i = 0; i < program->nslots; i++)
+         T_VarDelete(&program->slots[i]);
+
+      MemFree(program->slots);
+      if (program->image != NULL)
+         munmap(program->image, program->image_size);
+      else
+         MemFreeAligned(program->code, PROGRAM_ALIGN);
+      program->code = NULL;
+      program->image = NULL;
+      program->image_size = 0;
+
+      for (uint32_t i = 0; i < program->nglobals; i++)
+         MemFree(program->globals[i].name);
+      MemFree(program->globals);
+      program->globals = NULL;
+      program->nglobals = 0;
+      program->size = 0;
+      program->slots = NULL;
+      program->nslots = 0;
+   }
+}
+
+/* Presunie instrukcie programu nacitaneho z .fbc (viz BytecodeLoad()) na
+   haldu instancie a mapovanie uvolni. Vola sa pred prvym prepisom
+   instrukcie, mapovane stranky su len na citanie. Program na halde
+   nemeni.
+*/
+int T_ProgramUnmap(T_Program *program)
+{
+   PTR_CHECK(program);
+
+   if (program->image == NULL)
+      return EXIT_SUCCESS;
+
+   T_Code *code = MemAllocAligned(program->size * sizeof(T_Code), PROGRAM_ALIGN);
+   if (code == NULL) {
+      errno = INTERNAL_ERROR;
+      return EXIT_FAILURE;
+   }
+   memcpy(code, program->code, program->size * sizeof(T_Code));
+
+   munmap(program->image, program->image_size);
+   program->code = code;
+   program->image = NULL;
+   program->image_size = 0;
+   return EXIT_SUCCESS;
+}
+
+/* Skopiruje zlinkovany program do dest. Kopia ma vlastne pole instrukcii
+   na halde, aj ked src bezi z mapovaneho .fbc, lebo Interpret() ho za
+   behu prepisuje, a moze bezat v inom vlakne.
+*/
+int T_ProgramCopy(T_Program *dest, T_Program *src)
+{
+   PTR_CHECK(dest);
+   PTR_CHECK(src);
+
+   CALL_CHECK(T_ProgramInit(dest, src->size, src->nslots));
+   if (src->size > 0)
+      memcpy(dest->code, src->code, src->size * sizeof(T_Code));
+
+   for (uint32_t i = 0; i < src->nslots; i++) {
+      if (T_VarCopy(&dest->slots[i], &src->slots[i]) == EXIT_FAILURE) {
+         T_ProgramDelete(dest);
+         return EXIT_FAILURE;
+      }
+   }
+
+   if (src->nglobals > 0) {
+      if ((dest->globals = MemCalloc(src->nglobals, sizeof(T_Global))) == NULL) {
+         T_ProgramDelete(dest);
+         errno = INTERNAL_ERROR;
+         return EXIT_FAILURE;
+      }
+      dest->nglobals = src->nglobals;
+
+      for (uint32_t i = 0; i < src->nglobals; i++) {
+         dest->globals[i].slot = src->globals[i].slot;
+         if ((dest->globals[i].name = MemAlloc(strlen(src->globals[i].name) + 1)) == NULL) {
+            T_ProgramDelete(dest);
+            errno = INTERNAL_ERROR;
+            return EXIT_FAILURE;
+         }
+         strcpy(dest->globals[i].name, src->globals[i].name);
+      }
+   }
+
+   return EXIT_SUCCESS;
+}
+
+void T_ProgramPrint(T_Program *program)
+{
+   if (program == NULL)
+      return;
+
+   for (uint32_t i = 0; i < program->size; i++) {
+      T_Code *code = &program->code[i];
+      printf("  [%u] IID = %d, args = %d, %d, %d\n", i, code->IID, code->arg1, code->arg2, code->arg3);
+   }
+
+   for (uint32_t i = 0; i < program->nslots; i++) {
+      printf("  slot %u:", i);
+      T_VarPrint(&program->slots[i]);
+   }
+   printf("\n");
+}
+
+static int GlobalCompare(const void *key, const void *item)
+{
+   return strcmp(key, ((const T_Global *)item)->name);
+}
+
+/* Vrati slot premennej skriptu so zadanym menom alebo NO_SLOT.
+*/
+int32_t T_ProgramGlobal(T_Program *program, const char *name)
+{
+   if (program == NULL || name == NULL || program->nglobals == 0)
+      return NO_SLOT;
+
+   T_Global *global = bsearch(name, program->globals, program->nglobals, sizeof(T_Global), GlobalCompare);
+   return (global != NULL) ? (int32_t)global->slot : NO_SLOT;
+}
+
+/* Vytvori ramec jednej instancie programu ako kopiu jeho slotov.
+   Jeden zlinkovany program moze mat naraz viac ramcov.
+*/
+int T_FrameInit(T_Program *program, T_Var **frame)
+{
+   PTR_CHECK(program);
+   PTR_CHECK(frame);
+
+   // Aspon jeden slot, aby ramec nebol NULL ani pre prazdny program
+   T_Var *regs = MemAlloc((program->nslots + 1) * sizeof(T_Var));
+   PTR_CHECK(regs);
+
+   for (uint32_t i = 0; i < program->nslots; i++)
+      T_VarInit(&regs[i]);
+
+   for (uint32_t i = 0; i < program->nslots; i++) {
+      if (T_VarCopy(&regs[i], &program->slots[i]) == EXIT_FAILURE) {
+         T_FrameDelete(program, regs);
+         return EXIT_FAILURE;
+      }
+   }
+
+   *frame = regs;
+   return EXIT_SUCCESS;
+}
+
+void T_FrameDelete(T_Program *program, T_Var *frame)
+{
+   if (program != NULL && frame != NULL) {
+      for (uint32_t i = 0; i < program->nslots; i++)
+         T_VarDelete(&frame[i]);
+      MemFree(frame);
+   }
+}
+
+/* Inicializuje prazdny kontext interpretu. Lexer a parser si svoju cast
+   pripravia v LexInit() a SynanInit().
+*/
+int T_ContextInit(T_Context *ctx)
+{
+   PTR_CHECK(ctx);
+
+   memset(ctx, 0, sizeof(T_Context));
+   ctx->fd = NULL;
+   ctx->frame = NULL;
+   ctx->output = NULL;
+   ctx->output_data = NULL;
+   ctx->input = NULL;
+   ctx->globals = NULL;
+   ctx->stats = NULL;
+   ctx->budget = 0;
+   ctx->timeout = 0;
+   ctx->loops = 0;
+   ctx->suspended = 0;
+   ctx->pc = 0;
+   ctx->spent = 0;
+   ctx->deadline = 0;
+   HeapInit(&ctx->heap);
+   return T_ProgramInit(&ctx->program, 0, 0);
+}
+
+/* Uvolni program, ramec a premenne nastavene pred prekladom, zdrojovy subor zavrie LexFinish()
+   a stav parsera SynanFinish().
+*/
+void T_ContextDelete(T_Context *ctx)
+{
+   if (ctx != NULL) {
+      T_FrameDelete(&ctx->program, ctx->frame);
+      T_ProgramDelete(&ctx->program);
+      ctx->frame = NULL;
+
+      if (ctx->globals != NULL) {
+         T_HTableDelete(ctx->globals);
+         MemFree(ctx->globals);
+         ctx->globals = NULL;
+      }
+   }
+}
 
 /* Inicializuje zoznam tabuliek identifikatorov.
 */
@@ -527,7 +1202,7 @@ void T_IdListDelete(T_IdList *list)
 {
    if (list != NULL) {
       for (T_IdItem *tmp = list->first; tmp != NULL; tmp = tmp->next)
-         free(tmp);
+         MemFree(tmp);
       list->actual = NULL;
       list->first = NULL;
       list->last = NULL;
@@ -544,7 +1219,7 @@ int T_IdListAppend(T_IdList *list, T_HashTable *str)
 
    T_IdItem *new_item;
 
-   new_item = malloc(sizeof(struct T_IdentificatorItem));
+   new_item = MemAlloc(sizeof(struct T_IdentificatorItem));
    PTR_CHECK(new_item);
 
    new_item->data = str;
@@ -585,7 +1260,7 @@ void T_IdListDeleteLast(T_IdList *list)
       list->last->next = NULL;
    }
 
-   free(hitem);
+   MemFree(hitem);
 }
 
 // T_Arglist-------------------------------------------------------------------
@@ -627,7 +1302,7 @@ void T_ArgListDelete(T_ArgList *list)
 
    if (list != NULL) {
       for (T_ArgItem *tmp = list->first; tmp != NULL; tmp = tmp->next)
-         free(tmp);
+         MemFree(tmp);
       list->actual = NULL;
       list->first = NULL;
       list->last = NULL;
@@ -653,7 +1328,7 @@ int T_ArgListAppend(T_ArgList *list, T_String *instr)
    PTR_CHECK(instr);
    DEBUG_TARGLISTAPPEND(list, instr);
 
-   T_ArgItem *pomocna = malloc(sizeof(T_ArgItem));
+   T_ArgItem *pomocna = MemAlloc(sizeof(T_ArgItem));
 
    PTR_CHECK(pomocna);
 
@@ -674,121 +1349,23 @@ int T_ArgListAppend(T_ArgList *list, T_String *instr)
    return EXIT_SUCCESS;
 }
 
-// T_AllocList ----------------------------------------------------------------
-
-void T_AllocListPrint(T_AllocList *list)
-{
-   if (list == NULL)
-      return;
-
-   int i = 0;
-   T_AllocItem *hitem = list->first;
-
-   while (hitem != NULL) {
-      printf("  %d: addr=%p, ",i++,hitem->ptr);
-      hitem = hitem->next;
-   }
-   printf("\n");
-}
-
-int T_AllocListInit(T_AllocList *list)
-{
-  DEBUG_TALLOCLISTINIT(list);
-  PTR_CHECK(list);
-
-  list->first = NULL;
-  list->last = NULL;
-
-  DEBUG_TALLOCLISTINIT_END(list);
-  return EXIT_SUCCESS;
-}
-
-int T_AllocListAppend(T_AllocList *list, void *item)
-{
-   DEBUG_TALLOCLISTAPPEND_START(list,item);
-   PTR_CHECK(list);
-   PTR_CHECK(item);
-   DEBUG_TALLOCLISTAPPEND(list,item);
-
-   T_AllocItem *new_item = malloc(sizeof(T_AllocItem));
-   PTR_CHECK(new_item);
-
-   new_item->ptr = item;
-   new_item->next = NULL;
-
-   if (list->last == NULL) {
-      list->first = new_item;
-      list->last = new_item;
-   }
-   else {
-      list->last->next = new_item;
-      list->last = new_item;
-   }
-
-   DEBUG_TALLOCLISTAPPEND_END(list,item);
-   return EXIT_SUCCESS;
-}
-
-void T_AllocListDeleteLast(T_AllocList *list)
-{
-   DEBUG_TALLOCLISTDELETELAST_START(list);
-   if (list != NULL && list->last != NULL) {
-      DEBUG_TALLOCLISTDELETELAST(list);
-      T_AllocItem *hitem = list->last;
-
-   if (list->first == list->last) {
-      list->first = NULL;
-      list->last = NULL;
-   }
-   else {
-      list->last = list->first;
-
-      while (list->last->next != hitem)
-         list->last = list->last->next;
-
-      free(hitem);
-    }
-  }
-  DEBUG_TALLOCLISTDELETELAST_END(list);
-}
-
-void T_AllocListDelete(T_AllocList *list)
-{
-   DEBUG_TALLOCLISTDELETE_START(list);
-   if (list != NULL) {
-      while (list->first != list->last)
-         T_AllocListDeleteLast(list);
-
-      free(list->first);
-      list->first = NULL;
-      list->last = NULL;
-   }
-   DEBUG_TALLOCLISTDELETE_END(list);
-}
-
-/* Funkcia vybere podretazec z retazca od indexu from do indexu to.
-   Vrati ukazovatel na dany podretazec T_String alebo NULL pri chybe.
+/* Funkcia vybere podretazec z retazca od indexu from do indexu to do
+   inicializovaneho retazca substring, mimo rozsahu je vysledok prazdny.
 */
-int CutString(T_String *substring, T_String *string, double from, double to)
+int CutString(T_String *substring, T_String *string, int64_t from, int64_t to)
 {
-   from = (int)from;
-   to = (int)to;
-
    PTR_CHECK(substring);
+   PTR_CHECK(string);
 
-   substring->data = malloc(sizeof(char)*TSTRING_SIZE);
-   PTR_CHECK(substring->data);
-
-   if (from >= to || string->length < to) {
-      substring->data = "\0";
-      substring->length = 0;
-   }
-   else {
-      for (int j = 0, i = from; i < to; i++, j++)
-         T_StringAppend(substring, string->data[i]);
+   CALL_CHECK(T_StringReserve(substring, 0));
+   STRING_HEAD(substring)->length = 0;
+   substring->data[0] = '\0';
 
-      T_StringAppend(substring, '\0');
-      substring->length = strlen(substring->data);
+   if (from >= 0 && from < to && STRING_LENGTH(string) >= to) {
+      CALL_CHECK(T_StringReserve(substring, to - from));
+      memcpy(substring->data, string->data + from, to - from);
+      substring->data[to - from] = '\0';
+      STRING_HEAD(substring)->length = strlen(substring->data);
    }
    return EXIT_SUCCESS;
 }
@@ -811,8 +1388,8 @@ void T_LabelListDelete(T_LabelList *list)
       while (list->first != NULL) {
          pom = list->first;
          list->first = pom->next;
-         //free(&(pom->ptr_label));
-         free(pom);
+         POOL_DELETE(T_ListItem *, pom->ptr_label);
+         POOL_DELETE(T_LabelItem, pom);
       }
       list->last = NULL;
    }
@@ -824,10 +1401,10 @@ int T_LabelListAppend(T_LabelList *list, T_ListItem *label)
    PTR_CHECK(label);
 
    T_LabelItem *new_item;
-   new_item = malloc(sizeof(struct T_LabelItem));
+   new_item = POOL_NEW(T_LabelItem);
    PTR_CHECK(new_item);
 
-   new_item->ptr_label = malloc(sizeof(T_Instr*));
+   new_item->ptr_label = POOL_NEW(T_ListItem *);
    (*new_item->ptr_label) = label;
    new_item->next = NULL;
 
@@ -12,20 +12,44 @@
 
 #include <stdint.h> // uint8_t, uint32_t,  ...
 #include <stdio.h> // FILE
+#include <stddef.h> // size_t
 
-// T_String size exponent
+#include "alloc.h" // T_Heap
+
+// Smallest T_String buffer, buffers are multiples of it
 #define TSTRING_SIZE 8
 // T_Stack item space exponent
 #define TSTACK_SIZE 100
-
-// Numeric type identification
-#define NID_CONST -2.0
-#define NID_UNDEF -1.0
-#define NID_NIL 0.0
-#define NID_BOOL 1.0
-#define NID_NUMBER 3.0
-#define NID_FUNCTION 6.0
-#define NID_STRING 8.0
+// Alignment of T_Program instruction array (cache line)
+#define PROGRAM_ALIGN 64
+// Jump target which Link() couldn't resolve
+#define NO_TARGET -1
+// Unused operand of T_Code
+#define NO_SLOT -1
+
+// Numeric type identification, typeOf() returns it as a number
+#define NID_CONST -2
+#define NID_UNDEF -1
+#define NID_NIL 0
+#define NID_BOOL 1
+#define NID_NUMBER 3
+#define NID_FUNCTION 6
+#define NID_STRING 8
+
+// Internal subtype of NID_NUMBER and NID_STRING, invisible to typeOf() and print()
+#define SUB_NONE 0
+#define SUB_INT 1 // Integral number below INT_LIMIT kept in vals.i_val, see CDoubleToT_Var()
+#define SUB_ROPE 2 // String kept as a T_Rope tree in vals.rope, see T_VarFlatten()
+// Integers with SUB_INT stay below this magnitude, so a double holds them exactly
+#define INT_LIMIT 9007199254740992.0
+// Concatenations shorter than this stay flat, rope leaves are joined up to it
+#define ROPE_LEAF 512
+
+#define IS_ROPE(var) ((var)->NID == NID_STRING && (var)->sub == SUB_ROPE)
+// Value of a number variable, from whichever member holds it
+#define NUM_VAL(var) ((var)->sub == SUB_INT ? (double)(var)->vals.i_val : (var)->vals.d_val)
+// Length of a string variable, flat or rope
+#define VAR_LENGTH(var) (IS_ROPE(var) ? (var)->vals.rope->length : STRING_LENGTH(&(var)->vals.str))
 
 #define OP_EQUAL 100.0
 #define OP_UNEQUAL 101.0
@@ -43,11 +67,22 @@
 
 #define HASH_TABLE_SIZE 101  // size of Hash Table
 
+/* String of length characters followed by '\0'. The buffer starts with
+   a T_StringHead and data points right behind it, so a T_String is
+   a single pointer. data == NULL is an empty string without a buffer.
+*/
 typedef struct {
    uint32_t length;
+   uint32_t capacity; // Bytes behind the head, including the '\0'
+} T_StringHead;
+
+typedef struct {
    char *data;
 } T_String;
 
+#define STRING_HEAD(str) ((T_StringHead *)(void *)(str)->data - 1)
+#define STRING_LENGTH(str) ((str)->data != NULL ? STRING_HEAD(str)->length : 0)
+
 typedef struct T_ArgumentItem {
    struct T_ArgumentItem *next;
    T_String data;
@@ -60,14 +95,39 @@ typedef struct {
    int size;
 } T_ArgList;
 
+/* Node of a rope string. A leaf (left == NULL) owns the T_String buffer
+   data with length bytes, an inner node joins left and right. Nodes never
+   change, copies of a rope share them and count references. A single
+   leaf is also how T_VarShare() shares one flat buffer between copies,
+   a mutation first gets a private buffer from T_VarFlatten().
+*/
+typedef struct T_Rope {
+   uint32_t refs;
+   uint32_t length;
+   struct T_Rope *left;
+   struct T_Rope *right;
+   char *data;
+} T_Rope;
+
+/* Value of a variable. Every member of the union is at most a pointer or
+   a double wide: strings keep their length in the buffer head, function
+   arguments live out of line. A T_Var thus takes 16 bytes.
+   A number is either a double in vals.d_val or, with sub == SUB_INT,
+   an integer in vals.i_val, on which Interpret() runs integer arithmetic.
+   NUM_VAL() reads both. Whoever stores a double without CDoubleToT_Var()
+   resets sub.
+*/
 typedef struct {
    union {
       uint8_t b_val; // Bool value
       double d_val; // Double value
+      int64_t i_val; // Number with SUB_INT
       T_String str;
-      T_ArgList args;
+      T_Rope *rope; // String with SUB_ROPE
+      T_ArgList *args; // Function arguments, shared by copies of the function
    } vals;
-   double NID; // Numeric ID of a type/operator
+   int32_t NID; // Numeric ID of a type
+   int32_t sub; // Subtype of NID_NUMBER (SUB_*)
 } T_Var;
 
 typedef struct {
@@ -79,6 +139,7 @@ typedef struct {
 
 typedef struct {
    int IID; // Numeric ID of an instruction
+   int target; // Index of jump destination resolved by Link()
    T_Var *arg1; // Arguments
    T_Var *arg2;
    T_Var *arg3;
@@ -95,6 +156,33 @@ typedef struct {
    T_ListItem *actual;
 } T_List;
 
+/* Instruction of a linked program. Operands are indices into the frame
+   of the running instance, jumps keep the index of their destination
+   in the operand which named the label (arg1 of IID_JUMP, arg2 of IID_BRAFAL).
+*/
+typedef struct {
+   int32_t IID; // Numeric ID of an instruction
+   int32_t arg1; // Frame slots of arguments or NO_SLOT
+   int32_t arg2;
+   int32_t arg3;
+} T_Code;
+
+typedef struct {
+   char *name; // Name of a variable of the script
+   uint32_t slot; // Its frame slot
+} T_Global;
+
+typedef struct {
+   T_Code *code; // Contiguous instruction array aligned to PROGRAM_ALIGN
+   uint32_t size; // Number of instructions
+   T_Var *slots; // Initial content of a frame (constants, variables, temporaries)
+   uint32_t nslots; // Number of frame slots
+   T_Global *globals; // Variables of the script sorted by name, see T_ProgramGlobal()
+   uint32_t nglobals;
+   void *image; // Read-only mapping of the .fbc file code points into, NULL if code is on the heap
+   size_t image_size;
+} T_Program;
+
 typedef struct T_SemanTree {
 	int operation;
 	struct T_SemanTree *left;
@@ -131,15 +219,53 @@ typedef struct {
    T_IdItem *actual;
 } T_IdList;
 
-typedef struct T_AlocItem {
-  void *ptr;
-  struct T_AlocItem *next;
-} T_AllocItem;
-
-typedef struct {
-  T_AllocItem *first;
-  T_AllocItem *last;
-} T_AllocList;
+/* One instance of the interpreter: lexer input, parser state and the
+   linked program with its frame. Nothing else is shared between
+   instances, so each thread can compile and run its own program.
+*/
+typedef struct T_Context {
+   FILE *fd; // Source file read by GetToken()
+
+   // Parser state, valid between SynanInit() and SynanFinish()
+   T_HashTable *kw_table;
+   T_HashTable *builtin_table;
+   T_HashTable *id_table;
+   T_List *inst_list;
+   T_IdList *table_list;
+   T_LabelList *lbl_list;
+   T_LabelList *cal_list;
+   T_Var *read_var;
+   T_Var *write_var;
+   T_Instr instr;
+   T_String token;
+   int lex_rc;
+   int parentheses;
+   int params_count;
+   int tmp_count;
+
+   T_Program program; // Program run by Interpret()
+   T_Var *frame; // Frame of the program, created by T_FrameInit()
+
+   // Output of print(), stdout if NULL
+   void (*output)(void *data, const char *text, size_t length);
+   void *output_data;
+   FILE *input; // Input of input(), stdin if NULL
+   T_HashTable *globals; // Variables set before compilation, SynanInit() declares them
+   FILE *stats; // Where Optimize() statistics go, NULL for none
+
+   // Limits of one Interpret() run, 0 for none (see FalconSetLimits())
+   uint64_t budget; // Instructions
+   uint64_t timeout; // Nanoseconds of wall-clock time
+   int loops; // Backward jumps of program.code are IID_LOOP
+
+   // Run suspended by Interpret() after its slice
+   int suspended;
+   uint32_t pc; // Instruction the run continues with
+   uint64_t spent; // Instructions counted against budget so far
+   uint64_t deadline; // Monotonic ns when the run times out, 0 for none
+
+   T_Heap heap; // Memory of the instance and its quota (see FalconSetMemory())
+} T_Context;
 
 int T_LabelListInit(T_LabelList *list);
 void T_LabelListDelete(T_LabelList *list);
@@ -148,24 +274,29 @@ int T_LabelListAppend(T_LabelList *list, T_ListItem *label);
 void T_InstrPrint(T_Instr *instr);
 void T_VarPrint(T_Var *var);
 void T_ArgListPrint(T_ArgList *list);
-void T_AllocListPrint(T_AllocList *list);
 
 int T_VarInit(T_Var *var);
 void T_VarDelete(T_Var *var);
 int T_VarCopy(T_Var *write_var, T_Var *read_var);
+int T_VarShare(T_Var *write_var, T_Var *read_var);
 int CDoubleToT_Var(double val, T_Var *var);
 int T_StringToT_Var(T_String *str, T_Var *var);
+int T_VarConcat(T_Var *dest, T_Var *a, T_Var *b);
+int T_VarFlatten(T_Var *var);
+int T_VarCut(T_String *substring, T_Var *var, int64_t from, int64_t to);
+char T_VarFirstChar(T_Var *var);
 int IsFunction(T_Var *var);
 void T_VarPrint(T_Var *var);
 
 int T_StringInit(T_String *str);
+int T_StringReserve(T_String *str, size_t length);
 void T_StringDelete(T_String *str);
 uint32_t T_StringRead(FILE *fd, T_String *str, char end);
 int T_StringAppend(T_String *str, int c);
 int T_StringCat(T_String *dest, T_String *src);
 int T_StringCopy(T_String *dest, T_String *src);
 int CStringToT_String(char *c_str, T_String *str);
-int CutString(T_String *substring, T_String *string, double from, double to);
+int CutString(T_String *substring, T_String *string, int64_t from, int64_t to);
 
 
 int T_StackInit(T_Stack *stack);
@@ -180,6 +311,18 @@ int T_ListSucc(T_List *list);
 int T_ListAppend(T_List *list, T_Instr *instr);
 void T_ListPrint(T_List *list);
 
+int T_ProgramInit(T_Program *program, uint32_t size, uint32_t nslots);
+void T_ProgramDelete(T_Program *program);
+int T_ProgramUnmap(T_Program *program);
+int T_ProgramCopy(T_Program *dest, T_Program *src);
+void T_ProgramPrint(T_Program *program);
+int32_t T_ProgramGlobal(T_Program *program, const char *name);
+int T_FrameInit(T_Program *program, T_Var **frame);
+void T_FrameDelete(T_Program *program, T_Var *frame);
+
+int T_ContextInit(T_Context *ctx);
+void T_ContextDelete(T_Context *ctx);
+
 int T_ArgListInit(T_ArgList *list);
 void T_ArgListDelete(T_ArgList *list);
 int T_ArgListSucc(T_ArgList *list);
@@ -197,9 +340,5 @@ void T_IdListDelete(T_IdList *list);
 int T_IdListAppend(T_IdList *list, T_HashTable *str);
 void T_IdListDeleteLast(T_IdList *list);
 
-int T_AllocListInit(T_AllocList *list);
-int T_AllocListAppend(T_AllocList *list, void *item);
-void T_AllocListDeleteLast(T_AllocList *list);
-void T_AllocListDelete(T_AllocList *list);
 
 #endif
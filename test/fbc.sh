@@ -0,0 +1,67 @@
+#!/bin/bash
+# Nacitanie poskodenych suborov .fbc: zly operand musi loader odmietnut
+# s kodom 13 skor, nez by Interpret() siahol mimo ramca.
+#
+# BIN   interpret, ktory sa testuje (predvolene ./falcon-interpreter)
+
+BIN=${BIN:-./falcon-interpreter}
+
+dir=$(mktemp -d)
+trap 'rm -rf "$dir"' EXIT
+
+${CC:-gcc} -std=c99 -o "$dir/fbcpatch" "$(dirname "$0")/fbcpatch.c" \
+   || { echo "build of fbcpatch failed" >&2; exit 1; }
+
+IID_PLUS=8
+IID_PLUS_NUM=28
+NID_CONST=-2
+NID_FUNCTION=6
+NO_SLOT=-1
+failed=0
+
+# expect nazov kod - spusti $dir/nazov.fbc a porovna navratovy kod
+expect()
+{
+   "$BIN" "$dir/$1.fbc" >/dev/null 2>&1
+   local rc=$?
+   if [ "$rc" -eq "$2" ]; then
+      printf '%-16s ok\n' "$1"
+   else
+      printf '%-16s FAILED: exit code %d, expected %d\n' "$1" "$rc" "$2"
+      failed=1
+   fi
+}
+
+printf 'a = 1.0\nb = 2.0\nc = a + b\n' >"$dir/plus.fal"
+"$BIN" --compile "$dir/plus.fbc" "$dir/plus.fal" || exit 1
+expect plus 0
+
+# Ciel scitania mimo ramca
+cp "$dir/plus.fbc" "$dir/plus_dest.fbc"
+"$dir/fbcpatch" "$dir/plus_dest.fbc" $IID_PLUS 1 $NO_SLOT || exit 1
+expect plus_dest 13
+
+# Slot za koncom ramca
+cp "$dir/plus.fbc" "$dir/plus_range.fbc"
+"$dir/fbcpatch" "$dir/plus_range.fbc" $IID_PLUS 2 1000000 || exit 1
+expect plus_range 13
+
+# Specializovanu instrukciu by Run() prepisal v mapovanych strankach
+cp "$dir/plus.fbc" "$dir/plus_quick.fbc"
+"$dir/fbcpatch" "$dir/plus_quick.fbc" $IID_PLUS 0 $IID_PLUS_NUM || exit 1
+expect plus_quick 13
+
+# Typ slotu, ktory do zivej premennej nepatri
+cp "$dir/plus.fbc" "$dir/nid_const.fbc"
+"$dir/fbcpatch" "$dir/nid_const.fbc" nid 0 $NID_CONST || exit 1
+expect nid_const 13
+
+cp "$dir/plus.fbc" "$dir/nid_function.fbc"
+"$dir/fbcpatch" "$dir/nid_function.fbc" nid 0 $NID_FUNCTION || exit 1
+expect nid_function 13
+
+cp "$dir/plus.fbc" "$dir/nid_unknown.fbc"
+"$dir/fbcpatch" "$dir/nid_unknown.fbc" nid 0 99 || exit 1
+expect nid_unknown 13
+
+exit $failed
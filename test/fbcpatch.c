@@ -0,0 +1,67 @@
+// Prepise operand prvej instrukcie daneho IID v subore .fbc a prepocita
+// kontrolny sucet, aby zly operand zachytila az kontrola instrukcii.
+// Operand 0 je samotne IID. S "nid" namiesto IID prepise typ slotu
+// v tabulke konstant.
+//
+//    fbcpatch subor.fbc IID cislo_operandu hodnota
+//    fbcpatch subor.fbc nid slot hodnota
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../src/bytecode.h"
+
+int main(int argc, char **argv)
+{
+   if (argc != 5) {
+      fprintf(stderr, "pouzitie: fbcpatch subor.fbc IID|nid operand|slot hodnota\n");
+      return EXIT_FAILURE;
+   }
+   int IID = atoi(argv[2]);
+   int operand = atoi(argv[3]);
+   int32_t value = atoi(argv[4]);
+
+   FILE *file = fopen(argv[1], "r+b");
+   if (file == NULL || fseek(file, 0, SEEK_END) != 0)
+      return EXIT_FAILURE;
+   long size = ftell(file);
+   char *image = malloc(size);
+   rewind(file);
+   if (image == NULL || fread(image, 1, size, file) != (size_t)size)
+      return EXIT_FAILURE;
+
+   T_FbcHeader *header = (T_FbcHeader *)image;
+   if (strcmp(argv[2], "nid") == 0) {
+      T_FbcConst *consts = (T_FbcConst *)(image + header->consts_offset);
+      if (operand < 0 || (uint32_t)operand >= header->nslots) {
+         fprintf(stderr, "fbcpatch: slot %d neexistuje\n", operand);
+         return EXIT_FAILURE;
+      }
+      consts[operand].NID = value;
+   }
+   else {
+      T_Code *code = (T_Code *)(image + header->code_offset);
+      uint32_t i = 0;
+      while (i < header->size && code[i].IID != IID)
+         i++;
+      if (i == header->size || operand < 0 || operand > 3) {
+         fprintf(stderr, "fbcpatch: instrukcia %d nenajdena\n", IID);
+         return EXIT_FAILURE;
+      }
+      int32_t *args[4] = { &code[i].IID, &code[i].arg1, &code[i].arg2, &code[i].arg3 };
+      *args[operand] = value;
+   }
+
+   // FNV-1a suboru za hlavickou, rovnako ako Checksum() v src/bytecode.c
+   uint64_t hash = 14695981039346656037ULL;
+   for (long k = sizeof(T_FbcHeader); k < size; k++)
+      hash = (hash ^ (unsigned char)image[k]) * 1099511628211ULL;
+   header->checksum = hash;
+
+   rewind(file);
+   if (fwrite(image, 1, size, file) != (size_t)size || fclose(file) != 0)
+      return EXIT_FAILURE;
+   free(image);
+   return EXIT_SUCCESS;
+}